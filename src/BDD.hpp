@@ -1,96 +1,378 @@
 #pragma once
 
 #include "truth_table.hpp"
+#include "work_stealing.hpp"
+#include "big_uint.hpp"
+#include "chunked_array.hpp"
 
 #include <iostream>
 #include <vector>
+#include <string>
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <chrono>
+#include <cmath>
+#include <numeric>
 #include <unordered_map>
+#include <atomic>
+#include <memory>
 #include <functional>
+#include <new>
+#include <utility>
+#include <iterator>
+#include <random>
+#include <fstream>
+#include <type_traits>
 
-/* These are just some hacks to hash std::pair (for the unique table).
- * You don't need to understand this part. */
-namespace std
-{
-template<class T>
-inline void hash_combine( size_t& seed, T const& v )
-{
-  seed ^= hash<T>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-}
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-template<>
-struct hash<pair<uint32_t, uint32_t>>
+/* A BDD manager whose integer widths are fixed at compile time: `Index` holds edges (so a manager has at most
+ * 2^(bits - 1) nodes, including the constant) and `Var` holds variables (up to 2^27 - 1 of them, less if `Var`
+ * is narrower). Both must be unsigned and at least 16 bits wide. `Ref` holds the reference counts, which saturate
+ * (see `ref`). `BDD` below is the 32/32-bit instantiation; e.g. `Basic_BDD<uint64_t>` lifts the node limit and
+ * `Basic_BDD<uint32_t, uint16_t>` packs the nodes tighter. */
+template<typename Index = uint32_t, typename Var = uint32_t, typename Ref = uint32_t>
+class Basic_BDD
 {
-  using argument_type = pair<uint32_t, uint32_t>;
-  using result_type = size_t;
-  result_type operator() ( argument_type const& in ) const
-  {
-    result_type seed = 0;
-    hash_combine( seed, in.first );
-    hash_combine( seed, in.second );
-    return seed;
-  }
-};
-}
+  static_assert( std::is_unsigned<Index>::value && sizeof( Index ) >= 2u && sizeof( Index ) <= 8u,
+                 "Unsupported index type." );
+  static_assert( std::is_unsigned<Var>::value && sizeof( Var ) >= 2u && sizeof( Var ) <= 4u,
+                 "Unsupported variable type." );
+  static_assert( std::is_unsigned<Ref>::value, "Unsupported reference count type." );
 
-class BDD
-{
 public:
-  using index_t = uint32_t;
+  using index_t = Index;
   /* Declaring `index_t` as an alias for an unsigned integer.
    * This is just for easier understanding of the code.
    * This datatype will be used for node indices. */
 
-  using var_t = uint32_t;
+  using var_t = Var;
   /* Similarly, declare `var_t` also as an alias for an unsigned integer.
    * This datatype will be used for representing variables. */
 
+  using ref_t = Ref;
+  /* The datatype of the reference counts. */
+
+  /* Operators sharing the computed table. */
+  enum class Op : uint8_t
+  {
+    AND = 0,
+    OR,
+    XOR,
+    ITE,
+    EXISTS,
+    FORALL,
+    AND_EXISTS,
+    NUM_OPS
+  };
+
+  /* Per-operator computed table statistics. */
+  struct Cache_Stats
+  {
+    uint64_t hits = 0u; /* lookups answered by the table */
+    uint64_t misses = 0u; /* lookups that had to recurse */
+    uint64_t evictions = 0u; /* insertions that overwrote another entry */
+  };
+
+  /* Statistics of a variable reordering. */
+  struct Reorder_Stats
+  {
+    uint64_t nodes_before = 0u; /* living nodes before reordering */
+    uint64_t nodes_after = 0u; /* living nodes after reordering */
+    uint64_t num_swaps = 0u; /* number of adjacent level swaps performed */
+    double seconds = 0.0; /* time spent */
+  };
+
+  /* Per-operator counters. Every call is either a terminal case or a computed table lookup. */
+  struct Op_Stats
+  {
+    uint64_t calls = 0u; /* recursive calls, including the trivial ones */
+    uint64_t terminal_hits = 0u; /* calls answered by a terminal case */
+    Cache_Stats cache; /* the other calls */
+  };
+
+  /* Unique table counters of one level. */
+  struct Level_Stats
+  {
+    var_t var = 0u; /* variable at this level */
+    uint64_t nodes = 0u; /* nodes in the subtable, living or dead */
+    uint64_t buckets = 0u;
+    uint64_t lookups = 0u; /* searches by `unique` (or by the parallel operations) */
+    uint64_t probes = 0u; /* nodes compared during these searches */
+  };
+
+  /* A snapshot of the counters of the manager, see `stats`. */
+  struct Stats
+  {
+    double seconds = 0.0; /* since the construction of the manager */
+    std::array<Op_Stats, static_cast<uint32_t>( Op::NUM_OPS )> ops;
+    uint64_t not_calls = 0u;
+    std::vector<Level_Stats> levels; /* from the top */
+
+    uint64_t living_nodes = 0u;
+    uint64_t dead_nodes = 0u;
+    uint64_t peak_nodes = 0u; /* maximum of living + dead nodes */
+    uint64_t created_nodes = 0u; /* nodes created since the construction */
+
+    uint64_t num_gc = 0u; /* garbage collections that freed nodes */
+    uint64_t gc_freed_nodes = 0u;
+    double gc_seconds = 0.0;
+    double gc_max_pause = 0.0; /* in seconds */
+
+    uint64_t num_reorders = 0u;
+    uint64_t reorder_swaps = 0u;
+    double reorder_seconds = 0.0;
+
+    /* nodes created per second */
+    double allocation_rate() const
+    {
+      return seconds > 0.0 ? created_nodes / seconds : 0.0;
+    }
+
+    /* Write the counters as a JSON object. */
+    void write_json( std::ostream& os ) const
+    {
+      static char const* const op_names[] = { "and", "or", "xor", "ite", "exists", "forall", "and_exists" };
+      os << "{\n  \"seconds\": " << seconds << ",\n  \"ops\": {\n";
+      for ( uint32_t i = 0u; i < ops.size(); ++i )
+      {
+        Op_Stats const& op = ops[i];
+        os << "    \"" << op_names[i] << "\": { \"calls\": " << op.calls << ", \"terminal_hits\": " << op.terminal_hits
+           << ", \"cache_hits\": " << op.cache.hits << ", \"cache_misses\": " << op.cache.misses
+           << ", \"cache_evictions\": " << op.cache.evictions << " },\n";
+      }
+      os << "    \"not\": { \"calls\": " << not_calls << " }\n  },\n";
+      os << "  \"nodes\": { \"living\": " << living_nodes << ", \"dead\": " << dead_nodes
+         << ", \"peak\": " << peak_nodes << ", \"created\": " << created_nodes
+         << ", \"allocation_rate\": " << allocation_rate() << " },\n";
+      os << "  \"gc\": { \"count\": " << num_gc << ", \"freed_nodes\": " << gc_freed_nodes << ", \"seconds\": "
+         << gc_seconds << ", \"max_pause\": " << gc_max_pause << " },\n";
+      os << "  \"reorder\": { \"count\": " << num_reorders << ", \"swaps\": " << reorder_swaps << ", \"seconds\": "
+         << reorder_seconds << " },\n";
+      os << "  \"levels\": [";
+      for ( uint32_t level = 0u; level < levels.size(); ++level )
+      {
+        Level_Stats const& l = levels[level];
+        os << ( level == 0u ? "\n" : ",\n" ) << "    { \"var\": " << l.var << ", \"nodes\": " << l.nodes
+           << ", \"buckets\": " << l.buckets << ", \"load_factor\": " << double( l.nodes ) / l.buckets
+           << ", \"lookups\": " << l.lookups << ", \"probes\": " << l.probes << " }";
+      }
+      os << "\n  ]\n}\n";
+    }
+  };
+
 private:
+  /* The indices come first, so that no padding is needed between them. */
   struct Node
   {
+    index_t T; /* THEN edge, never complemented */
+    index_t E; /* ELSE edge (next free node if the node is on the free list) */
+    index_t next; /* next node in the same unique table chain */
+    ref_t ref; /* reference count, `saturated_ref` if it overflowed */
     var_t v; /* corresponding variable */
-    index_t T; /* index of THEN child */
-    index_t E; /* index of ELSE child */
   };
 
+  /* The unique table of one variable: a power-of-two array of chains linked through `Node::next`.
+   * When the table grows, the chains are migrated from `old_buckets` a few buckets at a time. */
+  struct Subtable
+  {
+    std::vector<index_t> buckets; /* first node of each chain, 0 for an empty chain */
+    std::vector<index_t> old_buckets; /* buckets before the last doubling, empty if fully migrated */
+    uint64_t num_migrated = 0u; /* number of `old_buckets` already moved into `buckets` */
+    uint64_t num_entries = 0u; /* number of nodes in the table */
+    uint64_t num_lookups = 0u; /* statistics: searches */
+    uint64_t num_probes = 0u; /* statistics: nodes compared during the searches */
+  };
+
+  struct Computed_Entry
+  {
+    index_t f, g, h; /* operands (unused ones are 0) */
+    uint32_t op; /* `Op` of the entry, `empty_entry` if the slot is unused */
+    index_t r; /* result */
+    uint32_t seq; /* odd while a parallel operation writes the entry, incremented twice per write */
+  };
+
+  /* An expansion in progress in `apply`: three operands and one 32-bit word of flags, i.e., 3 * sizeof( Index ) + 4
+   * bytes plus alignment padding (16 bytes with 32-bit indices), so that deep chains of them stay in cache. */
+  struct Apply_Frame
+  {
+    index_t f, g, h; /* operands, normalized as the key of the computed table (`h` is reused by binary operators) */
+    uint32_t then_branch : 1; /* 0 while computing the else cofactor, 1 while computing the then cofactor */
+    uint32_t complement : 1; /* whether to complement the result */
+    uint32_t split : 3; /* which of f, g and h (bits 0, 1 and 2) depend on the expanded variable (for the cube
+                         * of a quantification, whether the variable is quantified) */
+    uint32_t level : 27; /* level of the expanded variable */
+  };
+  static_assert( sizeof( index_t ) != 4u || sizeof( Apply_Frame ) == 16u, "Apply_Frame is meant to be 16 bytes." );
+
+  /* The scratch stacks and counters of a thread running `apply`. The sequential operations use context 0. */
+  struct Apply_Context
+  {
+    std::vector<Apply_Frame> stack; /* expansions in progress */
+    std::vector<index_t> results; /* else results waiting for the then results (ITE only) */
+    std::array<uint64_t, static_cast<uint32_t>( Op::NUM_OPS )> num_invoke{}; /* operation calls, including trivial ones */
+    std::array<Cache_Stats, static_cast<uint32_t>( Op::NUM_OPS )> cache_stats;
+
+    /* parallel operations only */
+    std::vector<index_t> lost_nodes; /* nodes allocated but inserted by another thread first */
+    std::vector<uint64_t> num_inserted; /* nodes inserted into each subtable by this thread */
+    std::vector<var_t> touched_vars; /* variables with `num_inserted` not 0 */
+    std::vector<var_t> overloaded_vars; /* subtables found too loaded */
+    std::vector<uint64_t> num_lookups, num_probes; /* unique table statistics of each variable, see `parallel_end` */
+  };
+
+  /* The then cofactor of an expansion of the parallel `apply`, which another thread may steal. */
+  struct Apply_Task : Stealable_Task
+  {
+    Apply_Task( Basic_BDD* manager, Op op, index_t f, index_t g, index_t h, uint32_t depth )
+      : manager( manager ), op( op ), f( f ), g( g ), h( h ), r( 0u ), depth( depth )
+    {
+    }
+
+    void run( uint32_t worker )
+    {
+      switch ( op )
+      {
+      case Op::AND:
+        r = manager->parallel_apply_rec<Op::AND>( worker, f, g, h, depth );
+        break;
+      case Op::OR:
+        r = manager->parallel_apply_rec<Op::OR>( worker, f, g, h, depth );
+        break;
+      case Op::XOR:
+        r = manager->parallel_apply_rec<Op::XOR>( worker, f, g, h, depth );
+        break;
+      case Op::EXISTS:
+        r = manager->parallel_apply_rec<Op::EXISTS>( worker, f, g, h, depth );
+        break;
+      case Op::FORALL:
+        r = manager->parallel_apply_rec<Op::FORALL>( worker, f, g, h, depth );
+        break;
+      case Op::AND_EXISTS:
+        r = manager->parallel_apply_rec<Op::AND_EXISTS>( worker, f, g, h, depth );
+        break;
+      default:
+        r = manager->parallel_apply_rec<Op::ITE>( worker, f, g, h, depth );
+      }
+    }
+
+    Basic_BDD* manager;
+    Op op;
+    index_t f, g, h, r;
+    uint32_t depth;
+  };
+
+  static constexpr uint32_t empty_entry = 0xffffffffu;
+
+  /* initial number of buckets of every subtable */
+  static constexpr uint64_t initial_buckets = 16u;
+
+  /* number of old buckets migrated by each insertion during a resize */
+  static constexpr uint64_t migration_step = 2u;
+
+  /* `v` of the nodes on the free list */
+  static constexpr var_t free_var = std::numeric_limits<var_t>::max();
+
+  /* A reference count reaching `saturated_ref` stays there: the node never dies. */
+  static constexpr ref_t saturated_ref = std::numeric_limits<ref_t>::max();
+
+  /* maximum number of nodes, including the constant: every node index must fit in an edge */
+  static constexpr uint64_t max_nodes = uint64_t( std::numeric_limits<index_t>::max() >> 1 ) + 1u;
+
+  /* The parallel `apply` spawns a task for the then cofactors in the first expansions only, and runs the sequential
+   * kernel below. 2^16 potential tasks are enough to balance the load of large operations. */
+  static constexpr uint32_t parallel_spawn_depth = 16u;
+
 public:
-  explicit BDD( uint32_t num_vars )
-    : unique_table( num_vars ), num_invoke_not( 0u ), num_invoke_and( 0u ), num_invoke_or( 0u ), 
-      num_invoke_xor( 0u ), num_invoke_ite( 0u )
-  {
-    nodes.emplace_back( Node({num_vars, 0, 0}) ); /* constant 0 */
-    nodes.emplace_back( Node({num_vars, 1, 1}) ); /* constant 1 */
-    /* `nodes` is initialized with two `Node`s representing the terminal (constant) nodes.
-     * Their `v` is `num_vars` and their indices are 0 and 1.
+  /* A manager of `num_vars` variables with a computed table of 2^`cache_size_log2` entries. The memory of
+   * `reserved_nodes` nodes is allocated up front (see `reserve`), with the pages chosen by `huge_pages`. */
+  explicit Basic_BDD( uint32_t num_vars, uint32_t cache_size_log2 = 16u, uint64_t reserved_nodes = 0u,
+                Huge_Pages huge_pages = Huge_Pages::NONE )
+    : unique_table( num_vars ), var2level( num_vars + 1u ), level2var( num_vars + 1u ),
+      free_list( 0u ), num_allocated( 0u ), num_dead( 0u ), gc_dead_ratio( 0.5 ), gc_min_nodes( 1u << 16 ),
+      reorder_max_growth( 1.2 ), reorder_time_limit( std::numeric_limits<double>::infinity() ),
+      auto_reorder( false ), auto_reorder_growth( 2.0 ), auto_reorder_min_nodes( 1u << 12 ),
+      next_reorder( 1u << 12 ), contexts( 1u ), parallel_next_node( 0u ), parallel_abort( false ),
+      parallel_reserve( 1u << 16 ), num_invoke_not( 0u ), construction_time( std::chrono::steady_clock::now() ),
+      num_created( 0u ), peak_allocated( 0u ), num_gc( 0u ), gc_freed_nodes( 0u ), gc_seconds( 0.0 ),
+      gc_max_pause( 0.0 ), num_reorders( 0u ), reorder_swaps( 0u ), reorder_seconds( 0.0 ), stats_interval( 0.0 )
+  {
+    assert( num_vars < ( 1u << 27 ) && num_vars < std::numeric_limits<var_t>::max() && "Too many variables." );
+    nodes.set_huge_pages( huge_pages );
+    reserve( reserved_nodes );
+    nodes.emplace_back( Node({0, 0, 0, 0, var_t( num_vars )}) ); /* constant 0 */
+    /* `nodes` is initialized with a single `Node` representing the terminal (constant 0) node.
+     * Its `v` is `num_vars` and its index is 0.
      * (Note that the real variables range from 0 to `num_vars - 1`.)
-     * Both of their children point to themselves, just for convenient representation.
+     * Both of its children point to itself, just for convenient representation.
      *
-     * `unique_table` is initialized with `num_vars` empty maps. */
+     * `unique_table` is initialized with `num_vars` empty subtables.
+     * The initial variable order is x_0 < x_1 < ... (x_0 on top); the terminal is at level `num_vars`. */
+    std::iota( var2level.begin(), var2level.end(), 0u );
+    std::iota( level2var.begin(), level2var.end(), 0u );
+    for ( auto& table : unique_table )
+    {
+      table.buckets.assign( initial_buckets, 0u );
+    }
+
+    resize_cache( cache_size_log2 );
   }
 
   /**********************************************************/
   /***************** Basic Building Blocks ******************/
   /**********************************************************/
 
+  /* An `index_t` handled by the operations below is an *edge*, not a plain node index:
+   * the node index is stored in the upper bits and the lowest bit is the complement attribute.
+   * Edge `2i` points to node `i`, and edge `2i + 1` points to the complement of node `i`.
+   * Only the constant 0 is stored; constant 1 is the complemented edge to it. */
+
   uint32_t num_vars() const
   {
     return unique_table.size();
   }
 
+  /* Allocate the memory of `num_nodes` nodes (besides the constant) now, instead of chunk by chunk as they are
+   * created. The allocated memory is never moved nor released before the manager is destroyed. */
+  void reserve( uint64_t num_nodes )
+  {
+    assert( num_nodes < max_nodes );
+    nodes.reserve( num_nodes + 1u );
+  }
+
   /* Get the (index of) constant node. */
   index_t constant( bool value ) const
   {
     return value ? 1 : 0;
   }
 
+  /* Whether the edge `f` is complemented. */
+  static bool is_complemented( index_t f )
+  {
+    return f & 1u;
+  }
+
+  /* Get the edge `f` with its complement attribute cleared. */
+  static index_t regular( index_t f )
+  {
+    return f & ~index_t( 1u );
+  }
+
   /* Look up (if exist) or build (if not) the node with variable `var`,
    * THEN child `T`, and ELSE child `E`. */
   index_t unique( var_t var, index_t T, index_t E )
   {
     assert( var < num_vars() && "Variables range from 0 to `num_vars - 1`." );
-    assert( T < nodes.size() && "Make sure the children exist." );
-    assert( E < nodes.size() && "Make sure the children exist." );
-    assert( nodes[T].v > var && "With static variable order, children can only be below the node." );
-    assert( nodes[E].v > var && "With static variable order, children can only be below the node." );
+    assert( ( T >> 1 ) < nodes.size() && "Make sure the children exist." );
+    assert( ( E >> 1 ) < nodes.size() && "Make sure the children exist." );
+    assert( level_of( T ) > var2level[var] && "Children can only be below the node in the current order." );
+    assert( level_of( E ) > var2level[var] && "Children can only be below the node in the current order." );
 
     /* Reduction rule: Identical children */
     if ( T == E )
@@ -98,20 +380,44 @@ public:
       return T;
     }
 
+    /* Canonical form: the THEN edge is never complemented.
+     * Otherwise, store the complement of the node and return a complemented edge to it. */
+    index_t const complement = T & 1u;
+    T ^= complement;
+    E ^= complement;
+
     /* Look up in the unique table. */
-    const auto it = unique_table[var].find( {T, E} );
-    if ( it != unique_table[var].end() )
+    Subtable& table = unique_table[var];
+    uint64_t const hash = hash_children( T, E );
+    index_t const existing = subtable_find( table, hash, T, E );
+    if ( existing != 0u )
     {
       /* The required node already exists. Return it. */
-      return it->second;
+      return ( existing << 1 ) | complement;
     }
     else
     {
-      /* Create a new node and insert it to the unique table. */
-      index_t const new_index = nodes.size();
-      nodes.emplace_back( Node({var, T, E}) );
-      unique_table[var][{T, E}] = new_index;
-      return new_index;
+      /* Create a new node and insert it to the unique table.
+       * Recycle a freed node if there is one. A new node is dead until it gets referenced. */
+      index_t new_index;
+      if ( free_list != 0u )
+      {
+        new_index = free_list;
+        free_list = nodes[new_index].E;
+        nodes[new_index] = Node({T, E, 0, 0, var});
+      }
+      else
+      {
+        assert( nodes.size() < max_nodes && "Too many nodes for `index_t`." );
+        new_index = nodes.size();
+        nodes.emplace_back( Node({T, E, 0, 0, var}) );
+      }
+      ++num_allocated;
+      ++num_dead;
+      ++num_created;
+      peak_allocated = std::max( peak_allocated, num_allocated );
+      subtable_insert( table, hash, new_index );
+      return ( new_index << 1 ) | complement;
     }
   }
 
@@ -122,431 +428,2863 @@ public:
   }
 
   /**********************************************************/
-  /********************* BDD Operations *********************/
+  /********* Reference Counting & Garbage Collection ********/
   /**********************************************************/
 
-  /* Compute ~f */
-  index_t NOT( index_t f )
-  {
-    assert( f < nodes.size() && "Make sure f exists." );
-    ++num_invoke_not;
+  /* A node is alive as long as it is referenced, either by the user or by a living parent.
+   * Invariant: a node holds one reference on each of its children if and only if it is alive.
+   * Nodes returned by the operations are dead until they get referenced with `ref`, and may be
+   * recycled by a garbage collection at the beginning of any later operation call (except the
+   * operands of that call). So always `ref` the results to be kept, and `deref` them when done.
+   * A count that would overflow `ref_t` saturates instead (as in CUDD): the node is then kept alive for good. */
 
-    /* trivial cases */
-    if ( f == constant( false ) )
-    {
-      return constant( true );
-    }
-    if ( f == constant( true ) )
+  /* Add a reference to `f`. Return `f` for convenience. */
+  index_t ref( index_t f )
+  {
+    assert( ( f >> 1 ) < nodes.size() && nodes[f >> 1].v != free_var && "Make sure f exists." );
+    ref_stack.emplace_back( f >> 1 );
+    while ( !ref_stack.empty() )
     {
-      return constant( false );
+      index_t const n = ref_stack.back();
+      ref_stack.pop_back();
+      if ( n == 0u )
+      {
+        continue;
+      }
+      Node& N = nodes[n];
+      if ( N.ref == saturated_ref )
+      {
+        continue;
+      }
+      if ( N.ref++ == 0u )
+      {
+        /* The node is revived: it takes its references on the children again. */
+        --num_dead;
+        ref_stack.emplace_back( N.T >> 1 );
+        ref_stack.emplace_back( N.E >> 1 );
+      }
     }
-
-    Node const& F = nodes[f];
-    var_t x = F.v;
-    index_t f0 = F.E, f1 = F.T;
-
-    index_t const r0 = NOT( f0 );
-    index_t const r1 = NOT( f1 );
-    return unique( x, r1, r0 );
+    return f;
   }
 
-  /* Compute f ^ g */
-  index_t XOR( index_t f, index_t g )
+  /* Remove a reference from `f`. */
+  void deref( index_t f )
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-    assert( g < nodes.size() && "Make sure g exists." );
-    ++num_invoke_xor;
-
-    /* trivial cases */
-    if ( f == g )
-    {
-      return constant( false );
-    }
-    if ( f == constant( false ) )
-    {
-      return g;
-    }
-    if ( g == constant( false ) )
-    {
-      return f;
-    }
-    if ( f == constant( true ) )
-    {
-      return NOT( g );
-    }
-    if ( g == constant( true ) )
-    {
-      return NOT( f );
-    }
-    if ( f == NOT( g ) )
-    {
-      return constant( true );
-    }
-
-    Node const& F = nodes[f];
-    Node const& G = nodes[g];
-    var_t x;
-    index_t f0, f1, g0, g1;
-    if ( F.v < G.v ) /* F is on top of G */
-    {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      g0 = g1 = g;
-    }
-    else if ( G.v < F.v ) /* G is on top of F */
+    assert( ( f >> 1 ) < nodes.size() && nodes[f >> 1].v != free_var && "Make sure f exists." );
+    ref_stack.emplace_back( f >> 1 );
+    while ( !ref_stack.empty() )
     {
-      x = G.v;
-      f0 = f1 = f;
-      g0 = G.E;
-      g1 = G.T;
-    }
-    else /* F and G are at the same level */
-    {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      g0 = G.E;
-      g1 = G.T;
+      index_t const n = ref_stack.back();
+      ref_stack.pop_back();
+      if ( n == 0u )
+      {
+        continue;
+      }
+      Node& N = nodes[n];
+      assert( N.ref > 0u && "Dereferencing a dead node." );
+      if ( N.ref == saturated_ref )
+      {
+        continue;
+      }
+      if ( --N.ref == 0u )
+      {
+        /* The node dies: it releases its references on the children. */
+        ++num_dead;
+        ref_stack.emplace_back( N.T >> 1 );
+        ref_stack.emplace_back( N.E >> 1 );
+      }
     }
-
-    index_t const r0 = XOR( f0, g0 );
-    index_t const r1 = XOR( f1, g1 );
-    return unique( x, r1, r0 );
   }
 
-  /* Compute f & g */
-  index_t AND( index_t f, index_t g )
+  /* Set when garbage collection is triggered automatically: before an operation, if at least `min_nodes`
+   * nodes are allocated and the dead ones make up more than `dead_ratio` of them. */
+  void set_gc_threshold( double dead_ratio, uint64_t min_nodes = 1u << 16 )
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-    assert( g < nodes.size() && "Make sure g exists." );
-    ++num_invoke_and;
-
-    /* trivial cases */
-    if ( f == constant( false ) || g == constant( false ) )
-    {
-      return constant( false );
-    }
-    if ( f == constant( true ) )
-    {
-      return g;
-    }
-    if ( g == constant( true ) )
-    {
-      return f;
-    }
-    if ( f == g )
-    {
-      return f;
-    }
-
-    Node const& F = nodes[f];
-    Node const& G = nodes[g];
-    var_t x;
-    index_t f0, f1, g0, g1;
-    if ( F.v < G.v ) /* F is on top of G */
-    {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      g0 = g1 = g;
-    }
-    else if ( G.v < F.v ) /* G is on top of F */
-    {
-      x = G.v;
-      f0 = f1 = f;
-      g0 = G.E;
-      g1 = G.T;
-    }
-    else /* F and G are at the same level */
-    {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      g0 = G.E;
-      g1 = G.T;
-    }
-
-    index_t const r0 = AND( f0, g0 );
-    index_t const r1 = AND( f1, g1 );
-    return unique( x, r1, r0 );
+    assert( dead_ratio >= 0.0 && dead_ratio <= 1.0 );
+    gc_dead_ratio = dead_ratio;
+    gc_min_nodes = min_nodes;
   }
 
-  /* Compute f | g */
-  index_t OR( index_t f, index_t g )
+  /* Free all dead nodes and put them on the free list. Return the number of freed nodes. */
+  uint64_t garbage_collect()
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-    assert( g < nodes.size() && "Make sure g exists." );
-    ++num_invoke_or;
-
-    /* trivial cases */
-    if ( f == constant( true ) || g == constant( true ) )
-    {
-      return constant( true );
-    }
-    if ( f == constant( false ) )
-    {
-      return g;
-    }
-    if ( g == constant( false ) )
-    {
-      return f;
-    }
-    if ( f == g )
+    if ( num_dead == 0u )
     {
-      return f;
+      return 0u;
     }
+    auto const start = std::chrono::steady_clock::now();
 
-    Node const& F = nodes[f];
-    Node const& G = nodes[g];
-    var_t x;
-    index_t f0, f1, g0, g1;
-    if ( F.v < G.v ) /* F is on top of G */
-    {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      g0 = g1 = g;
-    }
-    else if ( G.v < F.v ) /* G is on top of F */
+    /* Sweep the dead nodes out of the unique table. */
+    for ( auto& table : unique_table )
     {
-      x = G.v;
-      f0 = f1 = f;
-      g0 = G.E;
-      g1 = G.T;
+      subtable_finish_resize( table );
+      for ( auto& head : table.buckets )
+      {
+        index_t* link = &head;
+        while ( *link != 0u )
+        {
+          index_t const n = *link;
+          if ( nodes[n].ref == 0u )
+          {
+            *link = nodes[n].next;
+            nodes[n].v = free_var;
+            nodes[n].E = free_list;
+            free_list = n;
+            --table.num_entries;
+          }
+          else
+          {
+            link = &nodes[n].next;
+          }
+        }
+      }
     }
-    else /* F and G are at the same level */
+
+    /* Drop the computed table entries mentioning freed nodes. */
+    for ( auto& entry : cache )
     {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      g0 = G.E;
-      g1 = G.T;
+      if ( entry.op != empty_entry &&
+           ( nodes[entry.f >> 1].v == free_var || nodes[entry.g >> 1].v == free_var ||
+             nodes[entry.h >> 1].v == free_var || nodes[entry.r >> 1].v == free_var ) )
+      {
+        entry.op = empty_entry;
+      }
     }
 
-    index_t const r0 = OR( f0, g0 );
-    index_t const r1 = OR( f1, g1 );
-    return unique( x, r1, r0 );
+    uint64_t const num_freed = num_dead;
+    num_allocated -= num_dead;
+    num_dead = 0u;
+
+    double const pause = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    ++num_gc;
+    gc_freed_nodes += num_freed;
+    gc_seconds += pause;
+    gc_max_pause = std::max( gc_max_pause, pause );
+    return num_freed;
   }
 
-  /* Compute ITE(f, g, h), i.e., f ? g : h */
-  index_t ITE( index_t f, index_t g, index_t h )
+  /* Collect garbage, then renumber the living nodes level by level from the bottom: the nodes of a level become
+   * contiguous, the children come before their parents, and the freed nodes are dropped from the end of `nodes`.
+   * Every edge changes: the returned table gives the new index of each old node (0 for the freed ones), to be
+   * applied to the edges held outside with `remap_edge`. The reference counts move with the nodes. */
+  std::vector<index_t> compact()
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-    assert( g < nodes.size() && "Make sure g exists." );
-    assert( h < nodes.size() && "Make sure h exists." );
-    ++num_invoke_ite;
+    garbage_collect();
+    clear_cache();
 
-    /* trivial cases */
-    if ( f == constant( true ) )
-    {
-      return g;
-    }
-    if ( f == constant( false ) )
+    /* Number the living nodes from the bottom level up, then the free ones. */
+    uint64_t const size = nodes.size();
+    std::vector<index_t> remap( size, 0u );
+    /* the nodes of level l end up in [level_end[l + 1], level_end[l]) */
+    std::vector<index_t> level_end( num_vars() + 1u );
+    index_t next = 1u;
+    level_end[num_vars()] = next;
+    for ( uint32_t level = num_vars(); level-- > 0u; )
     {
-      return h;
+      Subtable& table = unique_table[level2var[level]];
+      subtable_finish_resize( table );
+      for ( index_t const head : table.buckets )
+      {
+        for ( index_t n = head; n != 0u; n = nodes[n].next )
+        {
+          remap[n] = next++;
+        }
+      }
+      level_end[level] = next;
     }
-    if ( g == h )
+    index_t const num_kept = next;
+    for ( index_t n = free_list; n != 0u; n = nodes[n].E )
     {
-      return g;
+      remap[n] = next++;
     }
+    assert( next == size && "Every node is living or free." );
 
-    Node const& F = nodes[f];
-    Node const& G = nodes[g];
-    Node const& H = nodes[h];
-    var_t x;
-    index_t f0, f1, g0, g1, h0, h1;
-    if ( F.v <= G.v && F.v <= H.v ) /* F is not lower than both G and H */
+    /* Rewrite the children, then move the nodes to their new places by following the cycles of the permutation. */
+    for ( index_t n = 1u; n < size; ++n )
     {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      if ( G.v == F.v )
-      {
-        g0 = G.E;
-        g1 = G.T;
-      }
-      else
-      {
-        g0 = g1 = g;
-      }
-      if ( H.v == F.v )
+      if ( nodes[n].v != free_var )
       {
-        h0 = H.E;
-        h1 = H.T;
-      }
-      else
-      {
-        h0 = h1 = h;
+        nodes[n].T = remap_edge( remap, nodes[n].T );
+        nodes[n].E = remap_edge( remap, nodes[n].E );
       }
     }
-    else /* F.v > min(G.v, H.v) */
+    std::vector<index_t> target( remap );
+    for ( index_t n = 1u; n < size; ++n )
     {
-      f0 = f1 = f;
-      if ( G.v < H.v )
-      {
-        x = G.v;
-        g0 = G.E;
-        g1 = G.T;
-        h0 = h1 = h;
-      }
-      else if ( H.v < G.v )
+      while ( target[n] != n )
       {
-        x = H.v;
-        g0 = g1 = g;
-        h0 = H.E;
-        h1 = H.T;
+        index_t const m = target[n];
+        std::swap( nodes[n], nodes[m] );
+        std::swap( target[n], target[m] );
       }
-      else /* G.v == H.v */
+    }
+    nodes.resize( num_kept );
+    free_list = 0u;
+
+    /* Rebuild the chains of the unique table. */
+    for ( uint32_t level = 0u; level < num_vars(); ++level )
+    {
+      Subtable& table = unique_table[level2var[level]];
+      std::fill( table.buckets.begin(), table.buckets.end(), 0u );
+      uint64_t const mask = table.buckets.size() - 1u;
+      for ( index_t n = level_end[level + 1u]; n < level_end[level]; ++n )
       {
-        x = G.v;
-        g0 = G.E;
-        g1 = G.T;
-        h0 = H.E;
-        h1 = H.T;
+        index_t& head = table.buckets[hash_children( nodes[n].T, nodes[n].E ) & mask];
+        nodes[n].next = head;
+        head = n;
       }
     }
 
-    index_t const r0 = ITE( f0, g0, h0 );
-    index_t const r1 = ITE( f1, g1, h1 );
-    return unique( x, r1, r0 );
+    for ( auto& m : remap )
+    {
+      m = m < num_kept ? m : 0u;
+    }
+    return remap;
+  }
+
+  /* Get the edge `f` renumbered by `compact`, which returned `remap`. */
+  static index_t remap_edge( std::vector<index_t> const& remap, index_t f )
+  {
+    return ( remap[f >> 1] << 1 ) | ( f & 1u );
   }
 
   /**********************************************************/
-  /***************** Printing and Evaluating ****************/
+  /****************** Variable Reordering *******************/
   /**********************************************************/
 
-  /* Print the BDD rooted at node `f`. */
-  void print( index_t f, std::ostream& os = std::cout ) const
+  /* Get the level of variable `var` in the current order (0 is the top). */
+  uint32_t level_of_var( var_t var ) const
   {
-    for ( auto i = 0u; i < nodes[f].v; ++i )
-    {
-      os << "  ";
-    }
-    if ( f <= 1 )
-    {
-      os << "node " << f << ": constant " << f << std::endl;
-    }
-    else
-    {
-      os << "node " << f << ": var = " << nodes[f].v << ", T = " << nodes[f].T 
-         << ", E = " << nodes[f].E << std::endl;
-      for ( auto i = 0u; i < nodes[f].v; ++i )
-      {
-        os << "  ";
-      }
-      os << "> THEN branch" << std::endl;
-      print( nodes[f].T, os );
-      for ( auto i = 0u; i < nodes[f].v; ++i )
-      {
-        os << "  ";
-      }
-      os << "> ELSE branch" << std::endl;
-      print( nodes[f].E, os );
-    }
+    assert( var < num_vars() );
+    return var2level[var];
   }
 
-  /* Get the truth table of the BDD rooted at node f. */
-  Truth_Table get_tt( index_t f ) const
+  /* Get the variable at level `level` in the current order. */
+  var_t var_at_level( uint32_t level ) const
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-    assert( num_vars() <= 6 && "Truth_Table only supports functions of no greater than 6 variables." );
-
-    if ( f == constant( false ) )
-    {
-      return Truth_Table( num_vars() );
-    }
-    else if ( f == constant( true ) )
-    {
-      return ~Truth_Table( num_vars() );
-    }
-    
-    /* Shannon expansion: f = x f_x + x' f_x' */
-    var_t const x = nodes[f].v;
-    index_t const fx = nodes[f].T;
-    index_t const fnx = nodes[f].E;
-    Truth_Table const tt_x = create_tt_nth_var( num_vars(), x );
-    Truth_Table const tt_nx = create_tt_nth_var( num_vars(), x, false );
-    return ( tt_x & get_tt( fx ) ) | ( tt_nx & get_tt( fnx ) );
+    assert( level < num_vars() );
+    return level2var[level];
   }
 
-  /* Whether `f` is dead (having a reference count of 0). */
-  bool is_dead( index_t f ) const
+  /* Swap the variables at levels `level` and `level + 1`.
+   * Like garbage collection, only the referenced BDDs are preserved. Their edges stay valid. */
+  void swap_levels( uint32_t level )
   {
-    /* TODO */
-    return false;
+    assert( level + 1u < num_vars() );
+    garbage_collect();
+    clear_cache();
+    swap_adjacent( level );
   }
 
-  /* Get the number of living nodes in the whole package, excluding constants. */
-  uint64_t num_nodes() const
+  /* Reorder the variables with Rudell's sifting to reduce the number of living nodes.
+   * Like garbage collection, only the referenced BDDs are preserved. Their edges stay valid. */
+  Reorder_Stats reorder()
   {
-    uint64_t n = 0u;
-    for ( auto i = 2u; i < nodes.size(); ++i )
+    auto const start = std::chrono::steady_clock::now();
+    Reorder_Stats stats;
+
+    /* Sifting relies on the absence of dead nodes. The computed table cannot survive the recycling of nodes. */
+    garbage_collect();
+    clear_cache();
+    stats.nodes_before = num_nodes();
+
+    /* Sift the variables with the most nodes first. */
+    std::vector<var_t> vars( num_vars() );
+    std::iota( vars.begin(), vars.end(), 0u );
+    std::stable_sort( vars.begin(), vars.end(), [this]( var_t a, var_t b ) {
+      return unique_table[a].num_entries > unique_table[b].num_entries;
+    } );
+    for ( var_t const v : vars )
     {
-      if ( !is_dead( i ) )
+      if ( std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() > reorder_time_limit )
       {
-        ++n;
+        break;
       }
+      sift_variable( v, start, stats );
     }
-    return n;
+
+    stats.nodes_after = num_nodes();
+    stats.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    next_reorder = std::max<uint64_t>( auto_reorder_min_nodes, auto_reorder_growth * stats.nodes_after );
+    last_reorder = stats;
+    ++num_reorders;
+    reorder_swaps += stats.num_swaps;
+    reorder_seconds += stats.seconds;
+    return stats;
   }
 
-  /* Get the number of nodes in the sub-graph rooted at node f, excluding constants. */
-  uint64_t num_nodes( index_t f ) const
+  /* Set the limits of sifting: a variable stops moving in one direction once the size exceeds
+   * `max_growth` times the best size seen, and reordering stops after `time_limit` seconds. */
+  void set_reorder_limits( double max_growth, double time_limit = std::numeric_limits<double>::infinity() )
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-
-    if ( f == constant( false ) || f == constant( true ) )
-    {
-      return 0u;
-    }
+    assert( max_growth >= 1.0 );
+    reorder_max_growth = max_growth;
+    reorder_time_limit = time_limit;
+  }
 
-    std::vector<bool> visited( nodes.size(), false );
-    visited[0] = true;
-    visited[1] = true;
+  /* Reorder automatically before an operation once the number of living nodes reaches `min_nodes`,
+   * and afterwards each time it reaches `growth` times the size after the last reordering. */
+  void enable_auto_reorder( double growth = 2.0, uint64_t min_nodes = 1u << 12 )
+  {
+    assert( growth > 1.0 );
+    auto_reorder = true;
+    auto_reorder_growth = growth;
+    auto_reorder_min_nodes = min_nodes;
+    next_reorder = std::max<uint64_t>( min_nodes, growth * last_reorder.nodes_after );
+  }
 
-    return num_nodes_rec( f, visited );
+  void disable_auto_reorder()
+  {
+    auto_reorder = false;
   }
 
-  uint64_t num_invoke() const
+  /* Get the statistics of the last reordering. */
+  Reorder_Stats const& last_reorder_stats() const
   {
-    return num_invoke_not + num_invoke_and + num_invoke_or + num_invoke_xor + num_invoke_ite;
+    return last_reorder;
   }
 
-private:
   /**********************************************************/
-  /******************** Helper Functions ********************/
+  /********************* BDD Operations *********************/
   /**********************************************************/
 
-  uint64_t num_nodes_rec( index_t f, std::vector<bool>& visited ) const
+  /* Compute ~f */
+  index_t NOT( index_t f )
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-    
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    ++num_invoke_not;
 
-    uint64_t n = 0u;
-    Node const& F = nodes[f];
-    assert( F.T < nodes.size() && "Make sure the children exist." );
-    assert( F.E < nodes.size() && "Make sure the children exist." );
-    if ( !visited[F.T] )
-    {
-      n += num_nodes_rec( F.T, visited );
-      visited[F.T] = true;
-    }
-    if ( !visited[F.E] )
+    /* With complemented edges, negation only toggles the complement attribute. */
+    return f ^ 1u;
+  }
+
+  /* Compute f ^ g */
+  index_t XOR( index_t f, index_t g )
+  {
+    prepare_operation( f, g );
+    return run_apply<Op::XOR>( f, g );
+  }
+
+  /* Compute f & g */
+  index_t AND( index_t f, index_t g )
+  {
+    prepare_operation( f, g );
+    return run_apply<Op::AND>( f, g );
+  }
+
+  /* Compute f | g */
+  index_t OR( index_t f, index_t g )
+  {
+    prepare_operation( f, g );
+    return run_apply<Op::OR>( f, g );
+  }
+
+  /* Compute ~(f & g) */
+  index_t NAND( index_t f, index_t g )
+  {
+    return connective( 0x7u, f, g );
+  }
+
+  /* Compute ~(f | g) */
+  index_t NOR( index_t f, index_t g )
+  {
+    return connective( 0x1u, f, g );
+  }
+
+  /* Compute ~(f ^ g) */
+  index_t XNOR( index_t f, index_t g )
+  {
+    return connective( 0x9u, f, g );
+  }
+
+  /* Compute f -> g, i.e., ~f | g */
+  index_t IMPLIES( index_t f, index_t g )
+  {
+    return connective( 0xdu, f, g );
+  }
+
+  /* Compute f & ~g */
+  index_t DIFF( index_t f, index_t g )
+  {
+    return connective( 0x2u, f, g );
+  }
+
+  /* Compute the 2-input function of f and g given by `table`: bit `a + 2b` of `table` is its value for f = a and
+   * g = b (i.e., the truth table of a function of x_0 = f and x_1 = g). With complemented edges, each of the 16
+   * functions is a constant, an operand, or a single AND, OR or XOR of the operands up to their negations, so no
+   * intermediate BDD is built. */
+  index_t connective( uint32_t table, index_t f, index_t g )
+  {
+    assert( table < 16u && "The table of a 2-input function has 4 bits." );
+    index_t r;
+    if ( connective_terminal( table, f, g, r ) )
+    {
+      return r;
+    }
+    if ( ( table & 5u ) == ( table >> 1 & 5u ) )
+    {
+      return unary_of( table & 1u, table >> 2 & 1u, g ); /* independent of f */
+    }
+    if ( ( table & 3u ) == ( table >> 2 ) )
+    {
+      return unary_of( table & 1u, table >> 1 & 1u, f ); /* independent of g */
+    }
+    uint32_t const ones = ( table & 1u ) + ( table >> 1 & 1u ) + ( table >> 2 & 1u ) + ( table >> 3 );
+    if ( ones == 2u )
+    {
+      /* XOR, or XNOR if the table is 1 at (0, 0) */
+      return XOR( f, g ) ^ ( table & 1u );
+    }
+
+    /* the only minterm (a, b) at which the function is 1 (AND) or 0 (OR) */
+    uint32_t const odd = ones == 1u ? table : ~table;
+    uint32_t m = 0u;
+    while ( ( odd >> m & 1u ) == 0u )
+    {
+      ++m;
+    }
+    if ( ones == 1u )
+    {
+      return AND( f ^ ( ~m & 1u ), g ^ ( ~m >> 1 & 1u ) ); /* f == a & g == b */
+    }
+    return OR( f ^ ( m & 1u ), g ^ ( m >> 1 ) ); /* f != a | g != b */
+  }
+
+  /* Compute ITE(f, g, h), i.e., f ? g : h */
+  index_t ITE( index_t f, index_t g, index_t h )
+  {
+    prepare_operation( f, g, h );
+    return run_apply<Op::ITE>( f, g, h );
+  }
+
+  /**********************************************************/
+  /********************* Quantification *********************/
+  /**********************************************************/
+
+  /* The variables to quantify are given either as a cube, the conjunction of their positive literals
+   * (as built by `cube`), or as a bitset indexed by variable. */
+
+  /* Build the cube of the variables `var` with `vars[var]` set. */
+  index_t cube( std::vector<bool> const& vars )
+  {
+    assert( vars.size() <= num_vars() );
+    index_t c = constant( true );
+    for ( uint32_t level = num_vars(); level-- > 0u; )
+    {
+      var_t const var = level2var[level];
+      if ( var < vars.size() && vars[var] )
+      {
+        c = unique( var, c, constant( false ) );
+      }
+    }
+    return c;
+  }
+
+  /* Compute (exists vars in `cube`) f */
+  index_t exists( index_t f, index_t cube )
+  {
+    assert( is_cube( cube ) && "The variables to quantify must be given as a cube of positive literals." );
+    prepare_operation( f, cube );
+    return run_apply<Op::EXISTS>( f, cube );
+  }
+
+  index_t exists( index_t f, std::vector<bool> const& vars )
+  {
+    return exists( f, cube( vars ) );
+  }
+
+  /* Compute (forall vars in `cube`) f */
+  index_t forall( index_t f, index_t cube )
+  {
+    assert( is_cube( cube ) && "The variables to quantify must be given as a cube of positive literals." );
+    prepare_operation( f, cube );
+    return run_apply<Op::FORALL>( f, cube );
+  }
+
+  index_t forall( index_t f, std::vector<bool> const& vars )
+  {
+    return forall( f, cube( vars ) );
+  }
+
+  /* Compute (exists vars in `cube`) f & g, the relational product, in a single pass:
+   * the variables are quantified as soon as they are expanded, so the conjunction is never built. */
+  index_t and_exists( index_t f, index_t g, index_t cube )
+  {
+    assert( is_cube( cube ) && "The variables to quantify must be given as a cube of positive literals." );
+    prepare_operation( f, g, cube );
+    return run_apply<Op::AND_EXISTS>( f, g, cube );
+  }
+
+  index_t and_exists( index_t f, index_t g, std::vector<bool> const& vars )
+  {
+    return and_exists( f, g, cube( vars ) );
+  }
+
+  /**********************************************************/
+  /*********************** Composition **********************/
+  /**********************************************************/
+
+  /* Compute f[var := g], i.e., ITE(g, f|var=1, f|var=0) */
+  index_t compose( index_t f, var_t var, index_t g )
+  {
+    assert( var < num_vars() );
+    std::vector<index_t> by_var = identity_substitution();
+    by_var[var] = g;
+    return substitute( f, by_var );
+  }
+
+  /* Substitute `functions.at( var )` for each variable `var` of the map, all at once. */
+  index_t compose( index_t f, std::unordered_map<var_t, index_t> const& functions )
+  {
+    std::vector<index_t> by_var = identity_substitution();
+    for ( auto const& substitution : functions )
+    {
+      assert( substitution.first < num_vars() );
+      by_var[substitution.first] = substitution.second;
+    }
+    return substitute( f, by_var );
+  }
+
+  /* Rename each variable `var` of `f` into `permutation[var]`. */
+  index_t permute( index_t f, std::vector<var_t> const& permutation )
+  {
+    assert( permutation.size() == num_vars() );
+    std::vector<index_t> by_var = identity_substitution();
+    for ( var_t v = 0u; v < num_vars(); ++v )
+    {
+      if ( permutation[v] != v )
+      {
+        by_var[v] = literal( permutation[v] );
+      }
+    }
+    return substitute( f, by_var );
+  }
+
+  /* Exchange the variables `x` and `y` in `f`. */
+  index_t swap_vars( index_t f, var_t x, var_t y )
+  {
+    assert( x < num_vars() && y < num_vars() );
+    std::vector<index_t> by_var = identity_substitution();
+    if ( x != y )
+    {
+      by_var[x] = literal( y );
+      by_var[y] = literal( x );
+    }
+    return substitute( f, by_var );
+  }
+
+  /**********************************************************/
+  /***************** Satisfying Assignments *****************/
+  /**********************************************************/
+
+  /* A cube gives each variable the value 0, 1 or `dont_care`, indexed by variable. */
+  using Cube = std::vector<uint8_t>;
+  static constexpr uint8_t dont_care = 2u;
+
+  /* Iterator over the cubes of the paths from an edge to the constant true, i.e., a disjoint cover of its function,
+   * in depth-first order with the THEN branches first. The current path is kept in an explicit stack and the cube
+   * is updated in place when advancing, so nothing is allocated per cube. The BDD must not change while iterating. */
+  class Cube_Iterator
+  {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Cube;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Cube const*;
+    using reference = Cube const&;
+
+    /* the end of any iteration */
+    Cube_Iterator() = default;
+
+    Cube_Iterator( Basic_BDD const& bdd, index_t f )
+      : bdd( &bdd ), cube( bdd.num_vars(), uint8_t( dont_care ) )
+    {
+      if ( f == bdd.constant( false ) )
+      {
+        this->bdd = nullptr;
+        return;
+      }
+      descend( f );
+    }
+
+    Cube const& operator*() const
+    {
+      return cube;
+    }
+
+    Cube const* operator->() const
+    {
+      return &cube;
+    }
+
+    Cube_Iterator& operator++()
+    {
+      /* Backtrack to the deepest THEN branch whose ELSE branch leads to true, and take it. */
+      while ( !path.empty() )
+      {
+        index_t const e = path.back();
+        var_t const v = bdd->nodes[e >> 1].v;
+        if ( cube[v] == 1u && bdd->else_of( e ) != bdd->constant( false ) )
+        {
+          cube[v] = 0u;
+          descend( bdd->else_of( e ) );
+          return *this;
+        }
+        cube[v] = dont_care;
+        path.pop_back();
+      }
+      bdd = nullptr;
+      return *this;
+    }
+
+    /* Only the end compares equal to the end. */
+    bool operator==( Cube_Iterator const& other ) const
+    {
+      return bdd == nullptr && other.bdd == nullptr;
+    }
+
+    bool operator!=( Cube_Iterator const& other ) const
+    {
+      return !( *this == other );
+    }
+
+  private:
+    /* Follow the first path from `e` to true, taking the THEN branch unless it is false. */
+    void descend( index_t e )
+    {
+      while ( ( e >> 1 ) != 0u )
+      {
+        path.emplace_back( e );
+        bool const then_branch = bdd->then_of( e ) != bdd->constant( false );
+        cube[bdd->nodes[e >> 1].v] = then_branch;
+        e = then_branch ? bdd->then_of( e ) : bdd->else_of( e );
+      }
+      assert( e == bdd->constant( true ) );
+    }
+
+  private:
+    Basic_BDD const* bdd = nullptr; /* nullptr at the end */
+    Cube cube;
+    std::vector<index_t> path; /* edges of the nodes on the current path, from the root */
+  };
+
+  /* The cubes of `f`, for use in a range-based for loop. */
+  struct Cube_Range
+  {
+    Cube_Iterator first;
+
+    Cube_Iterator begin() const
+    {
+      return first;
+    }
+
+    Cube_Iterator end() const
+    {
+      return Cube_Iterator();
+    }
+  };
+
+  /* Enumerate lazily the cubes of the paths from `f` to the constant true (see `Cube_Iterator`). */
+  Cube_Range cubes( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    return Cube_Range{ Cube_Iterator( *this, f ) };
+  }
+
+  /* Get the first cube of `cubes( f )`, following a single path. `f` must not be the constant false. */
+  Cube pick_one_cube( index_t f ) const
+  {
+    assert( f != constant( false ) && "The constant false has no cube." );
+    return *Cube_Iterator( *this, f );
+  }
+
+  /* Get a minterm of `f`, indexed by variable, following a single path: at each node with two branches leading to
+   * true, a branch is chosen with probability 1/2; the variables off the path are random. This is not uniform over
+   * the minterms, which would need their counts. `f` must not be the constant false. */
+  template<class Random_Generator>
+  std::vector<bool> pick_random_minterm( index_t f, Random_Generator& rng ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    assert( f != constant( false ) && "The constant false has no minterm." );
+    std::uniform_int_distribution<int> coin( 0, 1 );
+    std::vector<bool> minterm( num_vars() );
+    for ( var_t v = 0u; v < num_vars(); ++v )
+    {
+      minterm[v] = coin( rng );
+    }
+    while ( ( f >> 1 ) != 0u )
+    {
+      bool const then_branch = else_of( f ) == constant( false ) ||
+                               ( then_of( f ) != constant( false ) && coin( rng ) );
+      minterm[nodes[f >> 1].v] = then_branch;
+      f = then_branch ? then_of( f ) : else_of( f );
+    }
+    return minterm;
+  }
+
+  /**********************************************************/
+  /****************** Parallel Operations *******************/
+  /**********************************************************/
+
+  /* Run the Boolean operations and the quantifications on `num_threads` threads (1 runs them sequentially, the default).
+   * The two cofactors of the first expansions become tasks that idle threads steal, nodes are inserted into
+   * the unique table with compare-and-swap, and the computed table is shared. By canonicity, the results
+   * are the same edges as the sequential operations would return. */
+  void set_num_threads( uint32_t num_threads )
+  {
+    assert( num_threads > 0u );
+    pool.reset();
+    if ( num_threads > 1u )
+    {
+      pool.reset( new Work_Stealing_Pool<Apply_Task>( num_threads ) );
+    }
+    contexts.resize( std::max<std::size_t>( contexts.size(), num_threads ) );
+  }
+
+  uint32_t num_threads() const
+  {
+    return pool ? pool->num_workers() : 1u;
+  }
+
+  /**********************************************************/
+  /***************** Printing and Evaluating ****************/
+  /**********************************************************/
+
+  /* Print the BDD rooted at node `f`. */
+  void print( index_t f, std::ostream& os = std::cout ) const
+  {
+    /* Pending lines, last one first: an edge to print with its sub-graph, or a branch label under an edge. */
+    enum class Line : uint8_t
+    {
+      EDGE,
+      THEN_LABEL,
+      ELSE_LABEL
+    };
+    std::vector<std::pair<index_t, Line>> pending( 1u, std::make_pair( f, Line::EDGE ) );
+    while ( !pending.empty() )
+    {
+      index_t const e = pending.back().first;
+      Line const line = pending.back().second;
+      pending.pop_back();
+
+      uint32_t const level = level_of( e );
+      for ( auto i = 0u; i < level; ++i )
+      {
+        os << "  ";
+      }
+      if ( line == Line::THEN_LABEL )
+      {
+        os << "> THEN branch" << std::endl;
+      }
+      else if ( line == Line::ELSE_LABEL )
+      {
+        os << "> ELSE branch" << std::endl;
+      }
+      else if ( regular( e ) == constant( false ) )
+      {
+        os << "edge " << edge_to_string( e ) << ": constant " << e << std::endl;
+      }
+      else
+      {
+        Node const& F = nodes[e >> 1];
+        os << "edge " << edge_to_string( e ) << ": var = " << F.v << ", T = " << edge_to_string( F.T )
+           << ", E = " << edge_to_string( F.E ) << std::endl;
+        pending.emplace_back( F.E, Line::EDGE );
+        pending.emplace_back( e, Line::ELSE_LABEL );
+        pending.emplace_back( F.T, Line::EDGE );
+        pending.emplace_back( e, Line::THEN_LABEL );
+      }
+    }
+  }
+
+  /* Get the truth table of the BDD rooted at node f. */
+  Truth_Table get_tt( index_t f ) const
+  {
+    return get_tt( std::vector<index_t>( 1u, f ) )[0];
+  }
+
+  /* Get the truth tables of the BDDs rooted at nodes `fs`.
+   * Every node reachable from them is evaluated only once, bottom-up in level order. The table of a node only
+   * spans the support variables at or below its level, so the scratch memory stays close to the size of the output. */
+  std::vector<Truth_Table> get_tt( std::vector<index_t> const& fs ) const
+  {
+    assert( num_vars() < 64u && "Truth tables are limited to 63 variables." );
+    uint32_t const n = num_vars();
+
+    /* Collect the reachable nodes, children first. */
+    std::vector<index_t>& reachable = tt_nodes;
+    reachable.clear();
+    if ( tt_slot.size() < nodes.size() )
+    {
+      tt_slot.resize( nodes.size(), index_t( no_slot ) );
+    }
+    for ( index_t const f : fs )
+    {
+      assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+      collect_reachable( f >> 1, reachable );
+    }
+    std::sort( reachable.begin(), reachable.end(), [this]( index_t a, index_t b ) {
+      return var2level[nodes[a].v] > var2level[nodes[b].v];
+    } );
+
+    /* Rank the levels of the support; the terminal gets rank `support_size`.
+     * The table of a node of rank r has variable j for the support variable of rank r + j. */
+    std::vector<uint32_t> rank( n + 1u, 0u );
+    for ( index_t const m : reachable )
+    {
+      rank[var2level[nodes[m].v]] = 1u;
+    }
+    uint32_t support_size = 0u;
+    for ( uint32_t level = 0u; level <= n; ++level )
+    {
+      uint32_t const in_support = rank[level];
+      rank[level] = support_size;
+      support_size += in_support;
+    }
+
+    /* Give each node a slot of `num_words( support_size - rank )` words in the scratch buffer. */
+    tt_offsets.resize( reachable.size() );
+    uint64_t total_words = 0u;
+    for ( auto i = 0u; i < reachable.size(); ++i )
+    {
+      tt_slot[reachable[i]] = i;
+      tt_offsets[i] = total_words;
+      total_words += ::num_words( support_size - rank[level_of( reachable[i] << 1 )] );
+    }
+    if ( tt_scratch.size() < total_words )
+    {
+      tt_scratch.resize( total_words );
+    }
+
+    /* Evaluate f = x f_x + x' f_x' word by word, children first. The variable of the node is variable 0 of its table. */
+    for ( index_t const m : reachable )
+    {
+      Node const& N = nodes[m];
+      uint32_t const r = rank[var2level[N.v]];
+      uint64_t* const words = &tt_scratch[tt_offsets[tt_slot[m]]];
+      uint64_t const num_words = ::num_words( support_size - r );
+      for ( uint64_t w = 0u; w < num_words; ++w )
+      {
+        words[w] = ( tt_expanded_word( N.T, r, rank, w ) & var_mask_pos[0] ) |
+                   ( tt_expanded_word( N.E, r, rank, w ) & var_mask_neg[0] );
+      }
+    }
+
+    /* Spread the table of each root over all the variables of the manager. */
+    std::vector<Truth_Table> tts;
+    tts.reserve( fs.size() );
+    for ( index_t const f : fs )
+    {
+      tts.emplace_back( n );
+      Truth_Table& tt = tts.back();
+      uint64_t const flip = is_complemented( f ) ? ~uint64_t( 0 ) : 0u;
+      if ( ( f >> 1 ) == 0u )
+      {
+        std::fill( tt.bits.begin(), tt.bits.end(), flip );
+        tt.mask_bits();
+        continue;
+      }
+
+      /* `index[v]` is the bit of variable v in the table of f, if f depends on it. */
+      uint32_t const r = rank[level_of( f )];
+      std::vector<uint64_t> index( n, 0u );
+      for ( uint32_t level = level_of( f ); level < n; ++level )
+      {
+        if ( rank[level] != rank[level + 1u] )
+        {
+          index[level2var[level]] = uint64_t( 1 ) << ( rank[level] - r );
+        }
+      }
+      std::array<uint64_t, 64> low_index;
+      for ( uint32_t b = 0u; b < 64u; ++b )
+      {
+        low_index[b] = 0u;
+        for ( uint32_t v = 0u; v < 6u && v < n; ++v )
+        {
+          low_index[b] |= ( ( b >> v ) & 1u ) ? index[v] : 0u;
+        }
+      }
+
+      uint64_t const* const words = &tt_scratch[tt_offsets[tt_slot[f >> 1]]];
+      uint32_t const bits_per_word = n < 6u ? ( 1u << n ) : 64u;
+      for ( uint64_t w = 0u; w < tt.n_words(); ++w )
+      {
+        uint64_t high_index = 0u;
+        for ( uint32_t v = 6u; v < n; ++v )
+        {
+          high_index |= ( ( w >> ( v - 6u ) ) & 1u ) ? index[v] : 0u;
+        }
+        uint64_t result = 0u;
+        for ( uint32_t b = 0u; b < bits_per_word; ++b )
+        {
+          uint64_t const i = high_index | low_index[b];
+          result |= ( ( words[i >> 6] >> ( i & 63u ) ) & 1u ) << b;
+        }
+        tt.bits[w] = result ^ flip;
+      }
+      tt.mask_bits();
+    }
+
+    for ( index_t const m : reachable )
+    {
+      tt_slot[m] = no_slot;
+    }
+    return tts;
+  }
+
+  /* Evaluate the BDDs rooted at `roots` on 64 * `num_words` input patterns at once.
+   * `patterns[v * num_words + w]` gives variable v in patterns 64 w to 64 w + 63, one bit per pattern; the result
+   * is laid out the same way, with `r[i * num_words + w]` for `roots[i]`. Every node reachable from the roots is a
+   * bitwise multiplexer evaluated once per block of words, children first. */
+  std::vector<uint64_t> evaluate( std::vector<index_t> const& roots, std::vector<uint64_t> const& patterns,
+                                  uint64_t num_words = 1u ) const
+  {
+    assert( patterns.size() == num_vars() * num_words && "Give `num_words` words of patterns per variable." );
+
+    /* Collect the reachable nodes, children first. */
+    std::vector<index_t>& reachable = tt_nodes;
+    reachable.clear();
+    if ( tt_slot.size() < nodes.size() )
+    {
+      tt_slot.resize( nodes.size(), index_t( no_slot ) );
+    }
+    for ( index_t const f : roots )
+    {
+      assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+      collect_reachable( f >> 1, reachable );
+    }
+    std::sort( reachable.begin(), reachable.end(), [this]( index_t a, index_t b ) {
+      return var2level[nodes[a].v] > var2level[nodes[b].v];
+    } );
+    for ( auto i = 0u; i < reachable.size(); ++i )
+    {
+      tt_slot[reachable[i]] = i;
+    }
+
+    /* A block of words per node; the constant node (false) comes last. `tt_offsets` gives the block of each child
+     * and whether the edge to it is complemented. */
+    uint64_t const block = 8u;
+    auto const child = [&]( index_t e ) {
+      return ( uint64_t( ( e >> 1 ) == 0u ? reachable.size() : tt_slot[e >> 1] ) << 1 ) | ( e & 1u );
+    };
+    tt_offsets.resize( 2u * reachable.size() );
+    for ( auto i = 0u; i < reachable.size(); ++i )
+    {
+      tt_offsets[2u * i] = child( nodes[reachable[i]].T );
+      tt_offsets[2u * i + 1u] = child( nodes[reachable[i]].E );
+    }
+    if ( tt_scratch.size() < block * ( reachable.size() + 1u ) )
+    {
+      tt_scratch.resize( block * ( reachable.size() + 1u ) );
+    }
+    std::fill( &tt_scratch[block * reachable.size()], &tt_scratch[block * reachable.size()] + block, 0u );
+
+    std::vector<uint64_t> results( roots.size() * num_words );
+    for ( uint64_t start = 0u; start < num_words; start += block )
+    {
+      uint64_t const n = std::min( block, num_words - start );
+      for ( auto i = 0u; i < reachable.size(); ++i )
+      {
+        uint64_t const T = tt_offsets[2u * i], E = tt_offsets[2u * i + 1u];
+        tt_kernels::mux( &tt_scratch[block * i], &patterns[nodes[reachable[i]].v * num_words + start],
+                         &tt_scratch[block * ( T >> 1 )], ( T & 1u ) ? ~uint64_t( 0 ) : 0u,
+                         &tt_scratch[block * ( E >> 1 )], ( E & 1u ) ? ~uint64_t( 0 ) : 0u, n );
+      }
+      for ( auto j = 0u; j < roots.size(); ++j )
+      {
+        uint64_t const r = child( roots[j] );
+        uint64_t const flip = ( r & 1u ) ? ~uint64_t( 0 ) : 0u;
+        for ( uint64_t w = 0u; w < n; ++w )
+        {
+          results[j * num_words + start + w] = tt_scratch[block * ( r >> 1 ) + w] ^ flip;
+        }
+      }
+    }
+
+    for ( index_t const m : reachable )
+    {
+      tt_slot[m] = no_slot;
+    }
+    return results;
+  }
+
+  /* Evaluate `f` on the 64 input patterns given by `patterns[v]` for each variable v. */
+  uint64_t evaluate( index_t f, std::vector<uint64_t> const& patterns ) const
+  {
+    return evaluate( std::vector<index_t>( 1u, f ), patterns )[0];
+  }
+
+  /* Build the BDD of the function given by truth table `tt` over variables 0 to `tt.n_var() - 1`.
+   * The table is split recursively into cofactors following the variable order, calling `unique` directly.
+   * Identical sub-tables (up to complementation) are built only once. */
+  index_t from_tt( Truth_Table const& tt )
+  {
+    assert( tt.n_var() <= num_vars() && "The truth table has more variables than the manager." );
+    prepare_operation( constant( false ), constant( false ) );
+
+    std::vector<var_t> remaining( tt.n_var() );
+    std::iota( remaining.begin(), remaining.end(), 0u );
+    std::vector<std::unordered_map<Truth_Table, index_t, Truth_Table_Hash>> built( num_vars() );
+    return from_tt_rec( tt, 0u, remaining, built );
+  }
+
+  /* Whether `f` is dead (having a reference count of 0). */
+  bool is_dead( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    return ( f >> 1 ) != 0u && nodes[f >> 1].ref == 0u;
+  }
+
+  /* Get the number of living nodes in the whole package, excluding constants. */
+  uint64_t num_nodes() const
+  {
+    return num_allocated - num_dead;
+  }
+
+  /* Get the number of nodes in the sub-graph rooted at node f, excluding constants. */
+  uint64_t num_nodes( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+
+    if ( f == constant( false ) || f == constant( true ) )
+    {
+      return 0u;
+    }
+
+    if ( tt_slot.size() < nodes.size() )
+    {
+      tt_slot.resize( nodes.size(), index_t( no_slot ) );
+    }
+    tt_nodes.clear();
+    collect_reachable( f >> 1, tt_nodes );
+    for ( index_t const m : tt_nodes )
+    {
+      tt_slot[m] = no_slot;
+    }
+    return tt_nodes.size();
+  }
+
+  /* Get the variables `f` depends on, as a bitset indexed by variable. */
+  std::vector<bool> support( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+
+    std::vector<bool> vars( num_vars(), false );
+    if ( tt_slot.size() < nodes.size() )
+    {
+      tt_slot.resize( nodes.size(), index_t( no_slot ) );
+    }
+    tt_nodes.clear();
+    collect_reachable( f >> 1, tt_nodes );
+    for ( index_t const m : tt_nodes )
+    {
+      vars[nodes[m].v] = true;
+      tt_slot[m] = no_slot;
+    }
+    return vars;
+  }
+
+  /* Count the minterms of `f` as a function of `nvars` variables, which must include the variables it depends on. */
+  Big_Uint sat_count( index_t f, uint32_t nvars ) const
+  {
+    Big_Uint const count = count_paths( f, true );
+    if ( nvars >= num_vars() )
+    {
+      return count << ( nvars - num_vars() );
+    }
+    Big_Uint const r = count >> ( num_vars() - nvars );
+    assert( ( r << ( num_vars() - nvars ) ) == count && "f depends on more than nvars variables." );
+    return r;
+  }
+
+  /* Count the minterms of `f` as a function of all the variables. */
+  Big_Uint sat_count( index_t f ) const
+  {
+    return sat_count( f, num_vars() );
+  }
+
+  /* Count the paths from `f` to the constant true, i.e., the cubes of the disjoint cover given by the BDD. */
+  Big_Uint path_count( index_t f ) const
+  {
+    return count_paths( f, false );
+  }
+
+  /* Get the fraction of the assignments of the variables that satisfy `f`. */
+  double density( index_t f ) const
+  {
+    Big_Uint const count = count_paths( f, true );
+    uint64_t const dropped = count.num_bits() > 64u ? count.num_bits() - 64u : 0u;
+    return std::ldexp( double( ( count >> dropped ).to_uint64() ), int( dropped ) - int( num_vars() ) );
+  }
+
+  uint64_t num_invoke() const
+  {
+    uint64_t total = num_invoke_not;
+    for ( auto const& context : contexts )
+    {
+      total = std::accumulate( context.num_invoke.begin(), context.num_invoke.end(), total );
+    }
+    return total;
+  }
+
+  /* Get the computed table statistics of operator `op`, summed over all threads. */
+  Cache_Stats cache_stats( Op op ) const
+  {
+    assert( op < Op::NUM_OPS );
+    Cache_Stats total;
+    for ( auto const& context : contexts )
+    {
+      Cache_Stats const& stats = context.cache_stats[static_cast<uint32_t>( op )];
+      total.hits += stats.hits;
+      total.misses += stats.misses;
+      total.evictions += stats.evictions;
+    }
+    return total;
+  }
+
+  /* Get a snapshot of all the counters, summed over all threads. */
+  Stats stats() const
+  {
+    Stats s;
+    s.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - construction_time ).count();
+    for ( uint32_t i = 0u; i < s.ops.size(); ++i )
+    {
+      Op_Stats& op = s.ops[i];
+      op.cache = cache_stats( static_cast<Op>( i ) );
+      for ( auto const& context : contexts )
+      {
+        op.calls += context.num_invoke[i];
+      }
+      op.terminal_hits = op.calls - op.cache.hits - op.cache.misses;
+    }
+    s.not_calls = num_invoke_not;
+    s.levels.resize( num_vars() );
+    for ( uint32_t level = 0u; level < num_vars(); ++level )
+    {
+      Subtable const& table = unique_table[level2var[level]];
+      Level_Stats& l = s.levels[level];
+      l.var = level2var[level];
+      l.nodes = table.num_entries;
+      l.buckets = table.buckets.size();
+      l.lookups = table.num_lookups;
+      l.probes = table.num_probes;
+    }
+    s.living_nodes = num_nodes();
+    s.dead_nodes = num_dead;
+    s.peak_nodes = peak_allocated;
+    s.created_nodes = num_created;
+    s.num_gc = num_gc;
+    s.gc_freed_nodes = gc_freed_nodes;
+    s.gc_seconds = gc_seconds;
+    s.gc_max_pause = gc_max_pause;
+    s.num_reorders = num_reorders;
+    s.reorder_swaps = reorder_swaps;
+    s.reorder_seconds = reorder_seconds;
+    return s;
+  }
+
+  /* Call `callback` with `stats()` before an operation (AND, ITE, quantification...) when at least `interval` seconds
+   * passed since the last call. The first call comes with the next operation. An empty callback disables it. */
+  void set_stats_callback( std::function<void( Stats const& )> callback, double interval = 1.0 )
+  {
+    assert( interval >= 0.0 );
+    stats_callback = std::move( callback );
+    stats_interval = interval;
+    next_stats_report = std::chrono::steady_clock::now();
+  }
+
+  /**********************************************************/
+  /********************* Serialization **********************/
+  /**********************************************************/
+
+  /* The binary format (version 1) starts with the bytes "BDD" and 0, then has only unsigned LEB128 varints:
+   *   the version, the number of variables n, the variable of each level from the top, the number of nodes;
+   *   for each level from the bottom: its number of nodes, then for each of them `i - t` and `( i - e ) << 1 | c`,
+   *   where the nodes are numbered from 1 in the order of the file, i is the node, t and e its children (0 being
+   *   the constant false), and c whether the ELSE edge is complemented;
+   *   the number of roots, then each root as `index << 1 | complement`.
+   * The children come before their parents, so the deltas are positive and mostly small. */
+  static constexpr uint64_t binary_version = 1u;
+
+  /* Write the BDDs rooted at `roots` (and the variable order) to `os`. */
+  void save( std::ostream& os, std::vector<index_t> const& roots ) const
+  {
+    std::vector<index_t>& reachable = tt_nodes;
+    reachable.clear();
+    if ( tt_slot.size() < nodes.size() )
+    {
+      tt_slot.resize( nodes.size(), index_t( no_slot ) );
+    }
+    for ( index_t const f : roots )
+    {
+      assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+      collect_reachable( f >> 1, reachable );
+    }
+    std::sort( reachable.begin(), reachable.end(), [this]( index_t a, index_t b ) {
+      return var2level[nodes[a].v] > var2level[nodes[b].v];
+    } );
+
+    std::string out( "BDD", 4u );
+    put_varint( out, binary_version );
+    put_varint( out, num_vars() );
+    for ( uint32_t level = 0u; level < num_vars(); ++level )
+    {
+      put_varint( out, level2var[level] );
+    }
+    put_varint( out, reachable.size() );
+    auto const file_index = [&]( index_t e ) -> uint64_t { return ( e >> 1 ) == 0u ? 0u : tt_slot[e >> 1]; };
+    std::size_t i = 0u;
+    for ( uint32_t level = num_vars(); level-- > 0u; )
+    {
+      std::size_t const first = i;
+      while ( i < reachable.size() && var2level[nodes[reachable[i]].v] == level )
+      {
+        ++i;
+      }
+      put_varint( out, i - first );
+      for ( std::size_t j = first; j < i; ++j )
+      {
+        tt_slot[reachable[j]] = j + 1u;
+        Node const& N = nodes[reachable[j]];
+        put_varint( out, j + 1u - file_index( N.T ) );
+        put_varint( out, ( ( j + 1u - file_index( N.E ) ) << 1 ) | ( N.E & 1u ) );
+      }
+      if ( out.size() >= ( 1u << 20 ) )
+      {
+        os.write( out.data(), out.size() );
+        out.clear();
+      }
+    }
+    put_varint( out, roots.size() );
+    for ( index_t const f : roots )
+    {
+      put_varint( out, ( file_index( f ) << 1 ) | ( f & 1u ) );
+    }
+    os.write( out.data(), out.size() );
+
+    for ( index_t const m : reachable )
+    {
+      tt_slot[m] = no_slot;
+    }
+  }
+
+  /* Write the BDDs rooted at `roots` to the file `path`. Return whether it succeeded. */
+  bool save( std::string const& path, std::vector<index_t> const& roots ) const
+  {
+    std::ofstream os( path, std::ios::binary );
+    save( os, roots );
+    return bool( os );
+  }
+
+  /* Read BDDs written by `save` from the `size` bytes at `data`, and return their roots (not referenced), or nothing
+   * if the data is not valid. Each node is inserted directly into the unique table, whose subtables are grown once
+   * per level beforehand. Only a node whose variable does not come before its children in the current order (which
+   * is not the order of the file) is built with `ITE` instead. */
+  std::vector<index_t> load( uint8_t const* data, uint64_t size )
+  {
+    uint8_t const* const end = data + size;
+    if ( size < 4u || std::string( reinterpret_cast<char const*>( data ), 4u ) != std::string( "BDD", 4u ) )
+    {
+      return {};
+    }
+    data += 4u;
+    uint64_t version, file_vars, num_file_nodes;
+    if ( !get_varint( data, end, version ) || version != binary_version || !get_varint( data, end, file_vars ) ||
+         file_vars > num_vars() || file_vars > uint64_t( end - data ) )
+    {
+      return {};
+    }
+    std::vector<var_t> file_level2var( file_vars );
+    for ( auto& v : file_level2var )
+    {
+      uint64_t var;
+      if ( !get_varint( data, end, var ) || var >= num_vars() )
+      {
+        return {};
+      }
+      v = var;
+    }
+    /* A node takes at least 2 bytes: this bounds the allocations below. */
+    if ( !get_varint( data, end, num_file_nodes ) || num_file_nodes > uint64_t( end - data ) / 2u )
+    {
+      return {};
+    }
+
+    std::vector<index_t> built; /* edge of each node of the file, referenced */
+    built.reserve( num_file_nodes + 1u );
+    built.emplace_back( constant( false ) );
+    nodes.reserve( nodes.size() + num_file_nodes );
+    auto const release = [&]() {
+      for ( index_t const f : built )
+      {
+        deref( f );
+      }
+    };
+    auto const get_child = [&]( index_t& e, bool has_complement ) {
+      uint64_t x;
+      uint64_t const i = built.size();
+      if ( !get_varint( data, end, x ) )
+      {
+        return false;
+      }
+      uint64_t const delta = has_complement ? x >> 1 : x;
+      if ( delta == 0u || delta > i )
+      {
+        return false;
+      }
+      e = built[i - delta] ^ ( has_complement ? index_t( x & 1u ) : 0u );
+      return true;
+    };
+
+    for ( uint64_t level = file_vars; level-- > 0u; )
+    {
+      uint64_t count;
+      if ( !get_varint( data, end, count ) || count > num_file_nodes + 1u - built.size() )
+      {
+        release();
+        return {};
+      }
+      var_t const v = file_level2var[level];
+      Subtable& table = unique_table[v];
+      subtable_finish_resize( table );
+      while ( table.num_entries + count > table.buckets.size() )
+      {
+        subtable_start_resize( table );
+        subtable_finish_resize( table );
+      }
+      for ( uint64_t k = 0u; k < count; ++k )
+      {
+        index_t T, E;
+        if ( !get_child( T, false ) || !get_child( E, true ) )
+        {
+          release();
+          return {};
+        }
+        bool const in_order = level_of( T ) > var2level[v] && level_of( E ) > var2level[v];
+        built.emplace_back( ref( in_order ? unique( v, T, E ) : ITE( literal( v ), T, E ) ) );
+      }
+    }
+
+    uint64_t num_roots;
+    if ( built.size() != num_file_nodes + 1u || !get_varint( data, end, num_roots ) ||
+         num_roots > uint64_t( end - data ) )
+    {
+      release();
+      return {};
+    }
+    std::vector<index_t> roots;
+    for ( uint64_t j = 0u; j < num_roots; ++j )
+    {
+      uint64_t r;
+      if ( !get_varint( data, end, r ) || ( r >> 1 ) >= built.size() )
+      {
+        release();
+        return {};
+      }
+      roots.emplace_back( built[r >> 1] ^ index_t( r & 1u ) );
+    }
+    release();
+    return roots;
+  }
+
+  /* Read BDDs written by `save` from `is`. */
+  std::vector<index_t> load( std::istream& is )
+  {
+    std::vector<char> const buffer( ( std::istreambuf_iterator<char>( is ) ), std::istreambuf_iterator<char>() );
+    return load( reinterpret_cast<uint8_t const*>( buffer.data() ), buffer.size() );
+  }
+
+  /* Read BDDs written by `save` from the file `path`, which is memory-mapped where possible (on POSIX systems)
+   * rather than copied. Return nothing if the file cannot be read or is not valid. */
+  std::vector<index_t> load( std::string const& path )
+  {
+#if defined( __unix__ ) || defined( __APPLE__ )
+    int const fd = ::open( path.c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+      return {};
+    }
+    struct stat st;
+    if ( ::fstat( fd, &st ) != 0 || st.st_size == 0 )
+    {
+      ::close( fd );
+      return {};
+    }
+    uint64_t const size = st.st_size;
+    void* const mapped = ::mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd );
+    if ( mapped == MAP_FAILED )
+    {
+      return {};
+    }
+    ::madvise( mapped, size, MADV_SEQUENTIAL );
+    std::vector<index_t> const roots = load( static_cast<uint8_t const*>( mapped ), size );
+    ::munmap( mapped, size );
+    return roots;
+#else
+    std::ifstream is( path, std::ios::binary );
+    return load( is );
+#endif
+  }
+
+  /**********************************************************/
+  /********************* Computed Table *********************/
+  /**********************************************************/
+
+  /* Get the number of entries in the computed table. */
+  uint64_t cache_size() const
+  {
+    return cache.size();
+  }
+
+  /* Resize the computed table to 2^`size_log2` entries.
+   * All cached results are dropped; the statistics are kept. */
+  void resize_cache( uint32_t size_log2 )
+  {
+    assert( size_log2 < 32u && "Computed table is too large." );
+    cache.assign( 1ull << size_log2, Computed_Entry({0, 0, 0, empty_entry, 0, 0}) );
+    cache_mask = cache.size() - 1u;
+  }
+
+  /* Drop all cached results. */
+  void clear_cache()
+  {
+    for ( auto& entry : cache )
+    {
+      entry.op = empty_entry;
+    }
+  }
+
+private:
+  /**********************************************************/
+  /******************** Helper Functions ********************/
+  /**********************************************************/
+
+  /* Append `x` to `out` as an unsigned LEB128 varint: 7 bits per byte, the lowest first, the high bit set on all
+   * bytes but the last. */
+  static void put_varint( std::string& out, uint64_t x )
+  {
+    while ( x >= 0x80u )
+    {
+      out.push_back( char( ( x & 0x7fu ) | 0x80u ) );
+      x >>= 7;
+    }
+    out.push_back( char( x ) );
+  }
+
+  /* Read a varint written by `put_varint` at `data`, advancing it. Return false if it overruns `end`. */
+  static bool get_varint( uint8_t const*& data, uint8_t const* end, uint64_t& x )
+  {
+    x = 0u;
+    for ( uint32_t shift = 0u; data != end && shift < 64u; shift += 7u )
+    {
+      uint8_t const byte = *data++;
+      x |= uint64_t( byte & 0x7fu ) << shift;
+      if ( ( byte & 0x80u ) == 0u )
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /* The truth table of the connective `op` (see `connective`), 0 for the other operators. */
+  static constexpr uint32_t connective_table( Op op )
+  {
+    return op == Op::AND ? 0x8u : ( op == Op::OR ? 0xeu : ( op == Op::XOR ? 0x6u : 0u ) );
+  }
+
+  /* Whether the first two operands of `op` can be swapped. */
+  static constexpr bool is_commutative( Op op )
+  {
+    return op == Op::AND_EXISTS ||
+           ( connective_table( op ) != 0u && ( connective_table( op ) >> 1 & 1u ) == ( connective_table( op ) >> 2 & 1u ) );
+  }
+
+  /* The function of x alone with value `v0` for x = 0 and `v1` for x = 1. */
+  static index_t unary_of( uint32_t v0, uint32_t v1, index_t x )
+  {
+    return v0 == v1 ? index_t( v0 ) : index_t( x ^ v0 );
+  }
+
+  /* The trivial cases of the 2-input function `table` of f and g (see `connective`): return true with the result in `r`
+   * if a constant operand, or equal or complementary operands, reduce it to a function of one operand. */
+  static bool connective_terminal( uint32_t table, index_t f, index_t g, index_t& r )
+  {
+    if ( f == g )
+    {
+      r = unary_of( table & 1u, table >> 3, f );
+      return true;
+    }
+    if ( f == ( g ^ 1u ) )
+    {
+      r = unary_of( table >> 2 & 1u, table >> 1 & 1u, f );
+      return true;
+    }
+    if ( regular( f ) == 0u )
+    {
+      uint32_t const a = f & 1u;
+      r = unary_of( table >> a & 1u, table >> ( a + 2u ) & 1u, g );
+      return true;
+    }
+    if ( regular( g ) == 0u )
+    {
+      uint32_t const b = 2u * ( g & 1u );
+      r = unary_of( table >> b & 1u, table >> ( b + 1u ) & 1u, f );
+      return true;
+    }
+    return false;
+  }
+
+  /* Whether `op` has three operands (the others have two, and `h` is 0). */
+  static constexpr bool is_ternary( Op op )
+  {
+    return op == Op::ITE || op == Op::AND_EXISTS;
+  }
+
+  /* The operand (bit 1 for g, bit 2 for h) holding the cube of a quantification, 0 for the connectives. */
+  static constexpr uint32_t cube_operand( Op op )
+  {
+    return op == Op::EXISTS || op == Op::FORALL ? 2u : ( op == Op::AND_EXISTS ? 4u : 0u );
+  }
+
+  /* Get a cofactor of operand `f` of an expansion, `bit` being its bit in `split`.
+   * Both cofactors of a cube drop the quantified variable. */
+  template<Op op>
+  index_t cofactor( index_t f, uint32_t split, uint32_t bit, bool then_branch ) const
+  {
+    if ( ( split & bit ) == 0u )
+    {
+      return f;
+    }
+    return then_branch || bit == cube_operand( op ) ? then_of( f ) : else_of( f );
+  }
+
+  /* Compute `op`( f, g, h ) by Shannon expansion (`h` is unused by the binary operators).
+   * The expansion is driven by the explicit stack of `ctx` instead of native recursion, so the depth of the BDDs is
+   * only limited by memory. Each expansion pushes one frame and computes the else cofactor first, then the then
+   * cofactor (while the else result waits in the unused `h` of the frame, or on the result stack for the ternary
+   * operators), and finally combines both. This creates the nodes in the same order as the recursive formulation.
+   * When a quantification expands a variable of its cube, the cofactors are combined with OR (AND for FORALL)
+   * instead of a node, and the then cofactor is skipped if the else one already decides the result.
+   * The stacks are only appended to, so `apply` may be called again while one is running.
+   * With `concurrent`, other threads may work on the manager at the same time (see `parallel_apply`);
+   * 0 is returned if the parallel operation is aborted. */
+  template<Op op, bool concurrent>
+  index_t apply( Apply_Context& ctx, index_t f, index_t g, index_t h = 0u )
+  {
+    std::size_t const base = ctx.stack.size(), results_base = ctx.results.size();
+    while ( true )
+    {
+      index_t complement = 0u, r;
+      if ( !apply_terminal<op, concurrent>( ctx, f, g, h, complement, r ) )
+      {
+        if ( concurrent && parallel_abort.load( std::memory_order_relaxed ) )
+        {
+          ctx.stack.resize( base );
+          ctx.results.resize( results_base );
+          return 0u;
+        }
+
+        /* Expand with respect to the top variable of the operands, starting with the else cofactor. */
+        uint32_t const fl = level_of( f ), gl = level_of( g ), hl = is_ternary( op ) ? level_of( h ) : num_vars();
+        uint32_t const level = std::min( std::min( fl, gl ), hl );
+        uint32_t const split = ( fl == level ? 1u : 0u ) | ( gl == level ? 2u : 0u ) | ( hl == level ? 4u : 0u );
+        ctx.stack.emplace_back( Apply_Frame{f, g, h, 0u, uint32_t( complement ), split, level} );
+        f = cofactor<op>( f, split, 1u, false );
+        g = cofactor<op>( g, split, 2u, false );
+        h = cofactor<op>( h, split, 4u, false );
+        continue;
+      }
+
+      /* Pass `r` down the stack: combine it with the pending else results, until a then cofactor is due. */
+      while ( true )
+      {
+        if ( ctx.stack.size() == base )
+        {
+          return r;
+        }
+        Apply_Frame& frame = ctx.stack.back();
+        bool const quantified = ( frame.split & cube_operand( op ) ) != 0u;
+        index_t r0 = r;
+        if ( !frame.then_branch )
+        {
+          if ( !quantified || r != constant( op != Op::FORALL ) )
+          {
+            frame.then_branch = 1u;
+            if ( is_ternary( op ) )
+            {
+              ctx.results.emplace_back( r );
+            }
+            else
+            {
+              frame.h = r; /* free for binary operators */
+            }
+            f = cofactor<op>( frame.f, frame.split, 1u, true );
+            g = cofactor<op>( frame.g, frame.split, 2u, true );
+            h = is_ternary( op ) ? cofactor<op>( frame.h, frame.split, 4u, true ) : 0u;
+            break;
+          }
+        }
+        else if ( is_ternary( op ) )
+        {
+          r0 = ctx.results.back();
+          ctx.results.pop_back();
+        }
+        else
+        {
+          r0 = frame.h;
+        }
+
+        Apply_Frame const done = frame;
+        ctx.stack.pop_back();
+        if ( quantified )
+        {
+          r = apply<op == Op::FORALL ? Op::AND : Op::OR, concurrent>( ctx, r, r0 );
+        }
+        else if ( concurrent )
+        {
+          r = unique_concurrent( ctx, level2var[done.level], r, r0 );
+        }
+        else
+        {
+          r = unique( level2var[done.level], r, r0 );
+        }
+        if ( concurrent && parallel_abort.load( std::memory_order_relaxed ) )
+        {
+          ctx.stack.resize( base );
+          ctx.results.resize( results_base );
+          return 0u;
+        }
+        cache_insert<concurrent>( ctx, op, done.f, done.g, is_ternary( op ) ? done.h : 0u, r );
+        r ^= done.complement;
+      }
+    }
+  }
+
+  /* Run `op`( f, g, h ) sequentially or in parallel, depending on `set_num_threads`. */
+  template<Op op>
+  index_t run_apply( index_t f, index_t g, index_t h = 0u )
+  {
+    return pool ? parallel_apply<op>( f, g, h ) : apply<op, false>( contexts[0], f, g, h );
+  }
+
+  /* Compute `op`( f, g, h ) with the thread pool. Nodes are taken from the free list, then from a block reserved
+   * beforehand, and the subtables cannot grow during the operation: when either runs out, the operation is aborted,
+   * the manager grows, and the operation is restarted. The nodes and computed table entries of the aborted attempt are valid,
+   * so the new attempt resumes quickly. */
+  template<Op op>
+  index_t parallel_apply( index_t f, index_t g, index_t h )
+  {
+    while ( true )
+    {
+      parallel_begin();
+      Apply_Task root( this, op, f, g, h, 0u );
+      pool->run( root );
+      if ( parallel_end() )
+      {
+        return root.r;
+      }
+    }
+  }
+
+  /* One expansion of the parallel `apply`, run by `worker`: the then cofactor becomes a task while the else
+   * cofactor is computed. Below `parallel_spawn_depth`, the sequential kernel takes over. */
+  template<Op op>
+  index_t parallel_apply_rec( uint32_t worker, index_t f, index_t g, index_t h, uint32_t depth )
+  {
+    Apply_Context& ctx = contexts[worker];
+    if ( depth >= parallel_spawn_depth )
+    {
+      return apply<op, true>( ctx, f, g, h );
+    }
+    index_t complement = 0u, r;
+    if ( apply_terminal<op, true>( ctx, f, g, h, complement, r ) )
+    {
+      return r;
+    }
+    if ( parallel_abort.load( std::memory_order_relaxed ) )
+    {
+      return 0u;
+    }
+
+    uint32_t const fl = level_of( f ), gl = level_of( g ), hl = is_ternary( op ) ? level_of( h ) : num_vars();
+    uint32_t const level = std::min( std::min( fl, gl ), hl );
+    uint32_t const split = ( fl == level ? 1u : 0u ) | ( gl == level ? 2u : 0u ) | ( hl == level ? 4u : 0u );
+    Apply_Task then_task( this, op, cofactor<op>( f, split, 1u, true ), cofactor<op>( g, split, 2u, true ),
+                          cofactor<op>( h, split, 4u, true ), depth + 1u );
+    bool const spawned = pool->spawn( worker, then_task );
+    index_t const r0 = parallel_apply_rec<op>( worker, cofactor<op>( f, split, 1u, false ), cofactor<op>( g, split, 2u, false ),
+                                               cofactor<op>( h, split, 4u, false ), depth + 1u );
+    if ( spawned )
+    {
+      pool->sync( worker, then_task );
+    }
+    else
+    {
+      then_task.run( worker );
+    }
+    if ( parallel_abort.load( std::memory_order_relaxed ) )
+    {
+      return 0u;
+    }
+
+    if ( ( split & cube_operand( op ) ) != 0u )
+    {
+      r = apply<op == Op::FORALL ? Op::AND : Op::OR, true>( ctx, then_task.r, r0 );
+    }
+    else
+    {
+      r = unique_concurrent( ctx, level2var[level], then_task.r, r0 );
+    }
+    if ( parallel_abort.load( std::memory_order_relaxed ) )
+    {
+      return 0u;
+    }
+    cache_insert<true>( ctx, op, f, g, h, r );
+    return r ^ complement;
+  }
+
+  /* `unique` for the parallel operations. A new node is pushed on its chain with compare-and-swap; if the chain
+   * changed meanwhile, the nodes pushed by the other threads are checked before retrying. Sets `parallel_abort`
+   * if no node is left in the reserved block, or if the subtable is likely to be overloaded. */
+  index_t unique_concurrent( Apply_Context& ctx, var_t var, index_t T, index_t E )
+  {
+    assert( level_of( T ) > var2level[var] && "Children can only be below the node in the current order." );
+    assert( level_of( E ) > var2level[var] && "Children can only be below the node in the current order." );
+    if ( T == E )
+    {
+      return T;
+    }
+    index_t const complement = T & 1u;
+    T ^= complement;
+    E ^= complement;
+
+    Subtable& table = unique_table[var];
+    index_t* const bucket = &table.buckets[hash_children( T, E ) & ( table.buckets.size() - 1u )];
+    index_t head = __atomic_load_n( bucket, __ATOMIC_ACQUIRE );
+    if ( ctx.num_lookups.size() < num_vars() )
+    {
+      ctx.num_lookups.resize( num_vars(), 0u );
+      ctx.num_probes.resize( num_vars(), 0u );
+    }
+    ++ctx.num_lookups[var];
+    index_t const existing = chain_find( head, 0u, T, E, ctx.num_probes[var] );
+    if ( existing != 0u )
+    {
+      return ( existing << 1 ) | complement;
+    }
+
+    index_t const n = node_alloc_concurrent();
+    if ( n == 0u )
+    {
+      return 0u;
+    }
+    nodes[n].v = var;
+    nodes[n].T = T;
+    __atomic_store_n( &nodes[n].E, E, __ATOMIC_RELAXED ); /* may be read by a thread losing the race for `n` */
+    nodes[n].ref = 0u;
+    nodes[n].next = head;
+    while ( !__atomic_compare_exchange_n( bucket, &head, n, false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE ) )
+    {
+      index_t const other = chain_find( head, nodes[n].next, T, E, ctx.num_probes[var] );
+      if ( other != 0u )
+      {
+        ctx.lost_nodes.emplace_back( n );
+        return ( other << 1 ) | complement;
+      }
+      nodes[n].next = head;
+    }
+
+    /* Every thread counts its insertions: assume the other threads inserted as many. */
+    if ( ctx.num_inserted.size() < num_vars() )
+    {
+      ctx.num_inserted.resize( num_vars(), 0u );
+    }
+    if ( ctx.num_inserted[var]++ == 0u )
+    {
+      ctx.touched_vars.emplace_back( var );
+    }
+    if ( table.num_entries + ctx.num_inserted[var] * num_threads() > 2u * table.buckets.size() )
+    {
+      ctx.overloaded_vars.emplace_back( var );
+      parallel_abort.store( true, std::memory_order_relaxed );
+    }
+    return ( n << 1 ) | complement;
+  }
+
+  /* Take a node from the free list, or else from the block reserved by `parallel_begin`. Return 0 and abort if
+   * none is left. Nothing is pushed on the free list during a parallel operation, so popping with compare-and-swap
+   * is safe from ABA. */
+  index_t node_alloc_concurrent()
+  {
+    index_t n = __atomic_load_n( &free_list, __ATOMIC_ACQUIRE );
+    while ( n != 0u && !__atomic_compare_exchange_n( &free_list, &n, __atomic_load_n( &nodes[n].E, __ATOMIC_RELAXED ),
+                                                     false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE ) )
+    {
+    }
+    if ( n != 0u )
+    {
+      return n;
+    }
+    uint64_t const next = parallel_next_node.fetch_add( 1u, std::memory_order_relaxed );
+    if ( next >= nodes.size() )
+    {
+      parallel_abort.store( true, std::memory_order_relaxed );
+      return 0u;
+    }
+    return index_t( next );
+  }
+
+  /* Find the node with children `T` and `E` in the chain from `first` (included) to `last` (excluded).
+   * The compared nodes are counted in `probes`. */
+  index_t chain_find( index_t first, index_t last, index_t T, index_t E, uint64_t& probes ) const
+  {
+    uint64_t count = 0u;
+    for ( index_t n = first; n != last; n = nodes[n].next )
+    {
+      ++count;
+      if ( nodes[n].T == T && nodes[n].E == E )
+      {
+        probes += count;
+        return n;
+      }
+    }
+    probes += count;
+    return 0u;
+  }
+
+  /* Prepare the manager for a parallel operation: finish the subtable resizes and reserve a block of nodes. */
+  void parallel_begin()
+  {
+    for ( auto& table : unique_table )
+    {
+      subtable_finish_resize( table );
+    }
+    uint64_t const first = nodes.size();
+    parallel_next_node.store( first, std::memory_order_relaxed );
+    parallel_abort.store( false, std::memory_order_relaxed );
+    nodes.resize( std::min<uint64_t>( first + parallel_reserve, uint64_t( max_nodes ) ) ); /* written by `unique_concurrent` */
+  }
+
+  /* Account for the nodes created by a parallel operation, free the nodes that lost a race, and release the unused
+   * rest of the block reserved by `parallel_begin`. If the operation was aborted, grow what ran out and return false. */
+  bool parallel_end()
+  {
+    bool const aborted = parallel_abort.load( std::memory_order_relaxed );
+    uint64_t const capacity = nodes.size();
+    uint64_t const end = std::min<uint64_t>( parallel_next_node.load( std::memory_order_relaxed ), capacity );
+    nodes.resize( end );
+
+    /* The new nodes are dead, like the ones created by `unique`. */
+    std::vector<var_t> touched, overloaded;
+    for ( auto& ctx : contexts )
+    {
+      for ( index_t const n : ctx.lost_nodes )
+      {
+        nodes[n].v = free_var;
+        nodes[n].E = free_list;
+        free_list = n;
+      }
+      ctx.lost_nodes.clear();
+      for ( var_t const v : ctx.touched_vars )
+      {
+        unique_table[v].num_entries += ctx.num_inserted[v];
+        num_allocated += ctx.num_inserted[v];
+        num_dead += ctx.num_inserted[v];
+        num_created += ctx.num_inserted[v];
+        ctx.num_inserted[v] = 0u;
+      }
+      for ( var_t v = 0u; v < ctx.num_lookups.size(); ++v )
+      {
+        unique_table[v].num_lookups += ctx.num_lookups[v];
+        unique_table[v].num_probes += ctx.num_probes[v];
+        ctx.num_lookups[v] = ctx.num_probes[v] = 0u;
+      }
+      touched.insert( touched.end(), ctx.touched_vars.begin(), ctx.touched_vars.end() );
+      ctx.touched_vars.clear();
+      overloaded.insert( overloaded.end(), ctx.overloaded_vars.begin(), ctx.overloaded_vars.end() );
+      ctx.overloaded_vars.clear();
+    }
+    peak_allocated = std::max( peak_allocated, num_allocated );
+
+    /* Grow the subtables that are full. After an abort, grow the ones that caused it, and leave room for as many
+     * nodes again in all the subtables the operation inserted into, as it is likely to continue there. */
+    std::sort( overloaded.begin(), overloaded.end() );
+    overloaded.erase( std::unique( overloaded.begin(), overloaded.end() ), overloaded.end() );
+    for ( var_t const v : overloaded )
+    {
+      subtable_start_resize( unique_table[v] );
+      subtable_finish_resize( unique_table[v] );
+    }
+    uint64_t const max_load = aborted ? 2u : 1u;
+    for ( var_t const v : touched )
+    {
+      while ( max_load * unique_table[v].num_entries > unique_table[v].buckets.size() )
+      {
+        subtable_start_resize( unique_table[v] );
+        subtable_finish_resize( unique_table[v] );
+      }
+    }
+
+    /* If the block ran out, reserve at least as many nodes as there are next time, like `std::vector` would
+     * grow, so that a large operation restarts only a few times. (The reserved nodes are not initialized.) */
+    if ( end == capacity )
+    {
+      parallel_reserve = std::max<uint64_t>( 2u * parallel_reserve, end );
+    }
+    return !aborted;
+  }
+
+  /* The part of `apply` before the expansion of `op`( f, g, h ): return true with the result in `r`
+   * if it is a trivial case or is found in the computed table. Otherwise, the operands are left
+   * normalized as the key of the computed table, and the result must be complemented if `complement` is 1. */
+  template<Op op, bool concurrent>
+  bool apply_terminal( Apply_Context& ctx, index_t& f, index_t& g, index_t& h, index_t& complement, index_t& r )
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    assert( ( g >> 1 ) < nodes.size() && "Make sure g exists." );
+    assert( ( h >> 1 ) < nodes.size() && "Make sure h exists." );
+
+    ++ctx.num_invoke[static_cast<uint32_t>( op )];
+    switch ( op )
+    {
+    case Op::AND:
+    case Op::OR:
+    case Op::XOR:
+      if ( connective_terminal( connective_table( op ), f, g, r ) )
+      {
+        return true;
+      }
+      if ( op == Op::XOR )
+      {
+        /* ~f ^ g = f ^ ~g = ~(f ^ g): compute on regular edges and complement the result. */
+        complement = ( f ^ g ) & 1u;
+        f = regular( f );
+        g = regular( g );
+      }
+      break;
+
+    case Op::ITE:
+
+      /* trivial cases */
+      if ( f == constant( true ) )
+      {
+        r = g;
+        return true;
+      }
+      if ( f == constant( false ) )
+      {
+        r = h;
+        return true;
+      }
+
+      /* ITE(f, f, h) = ITE(f, 1, h), ITE(f, ~f, h) = ITE(f, 0, h),
+       * ITE(f, g, f) = ITE(f, g, 0), ITE(f, g, ~f) = ITE(f, g, 1) */
+      if ( regular( g ) == regular( f ) )
+      {
+        g = constant( g == f );
+      }
+      if ( regular( h ) == regular( f ) )
+      {
+        h = constant( h != f );
+      }
+      if ( g == h )
+      {
+        r = g;
+        return true;
+      }
+      if ( regular( g ) == constant( false ) && regular( h ) == constant( false ) )
+      {
+        r = f ^ h; /* ITE(f, 1, 0) = f, ITE(f, 0, 1) = ~f */
+        return true;
+      }
+
+      /* Degenerate triples are binary operators: they run on the cheaper kernel with its cache entries, and are
+       * counted as calls of that operator only. */
+      if ( g == ( h ^ 1u ) || regular( g ) == constant( false ) || regular( h ) == constant( false ) )
+      {
+        --ctx.num_invoke[static_cast<uint32_t>( op )];
+        if ( g == ( h ^ 1u ) )
+        {
+          r = apply<Op::XOR, concurrent>( ctx, f, h );
+        }
+        else if ( g == constant( true ) )
+        {
+          r = apply<Op::OR, concurrent>( ctx, f, h );
+        }
+        else if ( g == constant( false ) )
+        {
+          r = apply<Op::AND, concurrent>( ctx, f ^ 1u, h );
+        }
+        else if ( h == constant( false ) )
+        {
+          r = apply<Op::AND, concurrent>( ctx, f, g );
+        }
+        else
+        {
+          r = apply<Op::OR, concurrent>( ctx, f ^ 1u, g );
+        }
+        return true;
+      }
+
+      /* Standard triple: ITE(~f, g, h) = ITE(f, h, g) makes f regular, then ITE(f, ~g, ~h) = ~ITE(f, g, h) makes g
+       * regular, so that the equivalent calls share one computed table entry. */
+      if ( is_complemented( f ) )
+      {
+        f ^= 1u;
+        std::swap( g, h );
+      }
+      complement = g & 1u;
+      g ^= complement;
+      h ^= complement;
+      break;
+
+    case Op::EXISTS:
+    case Op::FORALL:
+
+      /* f does not depend on the variables of the cube above it. */
+      while ( level_of( g ) < level_of( f ) )
+      {
+        g = then_of( g );
+      }
+
+      /* trivial cases (including constant f) */
+      if ( g == constant( true ) )
+      {
+        r = f;
+        return true;
+      }
+      break;
+
+    case Op::AND_EXISTS:
+
+      /* trivial cases */
+      if ( f == constant( false ) || g == constant( false ) || f == ( g ^ 1u ) )
+      {
+        r = constant( false );
+        return true;
+      }
+      while ( level_of( h ) < std::min( level_of( f ), level_of( g ) ) )
+      {
+        h = then_of( h );
+      }
+
+      /* Only one of the two operations is left. */
+      if ( h == constant( true ) )
+      {
+        r = apply<Op::AND, concurrent>( ctx, f, g );
+        return true;
+      }
+      if ( f == constant( true ) || f == g )
+      {
+        r = apply<Op::EXISTS, concurrent>( ctx, g, h );
+        return true;
+      }
+      if ( g == constant( true ) )
+      {
+        r = apply<Op::EXISTS, concurrent>( ctx, f, h );
+        return true;
+      }
+      break;
+
+    default:
+      assert( false && "Unknown operator." );
+    }
+
+    /* Normalize the operand order of the commutative operators to share cache entries. */
+    if ( is_commutative( op ) && f > g )
+    {
+      std::swap( f, g );
+    }
+    if ( cache_lookup<concurrent>( ctx, op, f, g, h, r ) )
+    {
+      r ^= complement;
+      return true;
+    }
+    return false;
+  }
+
+  /* Collect garbage if the threshold set by `set_gc_threshold` is reached, and reorder the
+   * variables if automatic reordering is enabled and the living nodes reached its threshold.
+   * The operands `f`, `g` and `h` of the upcoming operation are protected. */
+  void prepare_operation( index_t f, index_t g, index_t h = 0u )
+  {
+    if ( stats_callback && std::chrono::steady_clock::now() >= next_stats_report )
+    {
+      /* Scheduled first, in case the callback runs operations. */
+      next_stats_report = std::chrono::steady_clock::now() +
+                          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                              std::chrono::duration<double>( stats_interval ) );
+      stats_callback( stats() );
+    }
+    bool const collect = num_allocated >= gc_min_nodes && num_dead > gc_dead_ratio * num_allocated;
+    bool const reorder_now = auto_reorder && num_nodes() >= next_reorder;
+    if ( !collect && !reorder_now )
+    {
+      return;
+    }
+    ref( f ); ref( g ); ref( h );
+    if ( reorder_now )
+    {
+      reorder(); /* also collects garbage */
+    }
+    else
+    {
+      garbage_collect();
+    }
+    deref( f ); deref( g ); deref( h );
+  }
+
+  /* Remove a reference from `f` like `deref`, but free the nodes that die right away.
+   * Only used during reordering, when there is no dead node that could still point to them. */
+  void deref_and_free( index_t f )
+  {
+    ref_stack.emplace_back( f >> 1 );
+    while ( !ref_stack.empty() )
+    {
+      index_t const n = ref_stack.back();
+      ref_stack.pop_back();
+      if ( n == 0u )
+      {
+        continue;
+      }
+      Node& N = nodes[n];
+      assert( N.ref > 0u && "Dereferencing a dead node." );
+      if ( N.ref == saturated_ref )
+      {
+        continue;
+      }
+      if ( --N.ref == 0u )
+      {
+        ref_stack.emplace_back( N.T >> 1 );
+        ref_stack.emplace_back( N.E >> 1 );
+        subtable_remove( unique_table[N.v], n );
+        N.v = free_var;
+        N.E = free_list;
+        free_list = n;
+        --num_allocated;
+      }
+    }
+  }
+
+  /* Swap the variables at levels `level` and `level + 1` in place.
+   * Every node keeps its index and its function, so all the edges held outside stay valid.
+   * Requires that there is no dead node (see `deref_and_free`). */
+  void swap_adjacent( uint32_t level )
+  {
+    var_t const x = level2var[level], y = level2var[level + 1u];
+
+    /* Take out the nodes of x that depend on y. The other ones simply move down together with x. */
+    Subtable& table = unique_table[x];
+    subtable_finish_resize( table );
+    swap_scratch.clear();
+    for ( auto& head : table.buckets )
+    {
+      index_t* link = &head;
+      while ( *link != 0u )
+      {
+        index_t const n = *link;
+        if ( var_of( nodes[n].T ) == y || var_of( nodes[n].E ) == y )
+        {
+          *link = nodes[n].next;
+          --table.num_entries;
+          swap_scratch.emplace_back( n );
+        }
+        else
+        {
+          link = &nodes[n].next;
+        }
+      }
+    }
+
+    std::swap( level2var[level], level2var[level + 1u] );
+    var2level[x] = level + 1u;
+    var2level[y] = level;
+
+    /* Rewrite f = x ? ( y ? f11 : f10 ) : ( y ? f01 : f00 )
+     * into    f = y ? ( x ? f11 : f01 ) : ( x ? f10 : f00 ). */
+    for ( index_t const n : swap_scratch )
+    {
+      index_t const T = nodes[n].T, E = nodes[n].E;
+      index_t f11, f10, f01, f00;
+      if ( var_of( T ) == y )
+      {
+        f11 = then_of( T );
+        f10 = else_of( T );
+      }
+      else
+      {
+        f11 = f10 = T;
+      }
+      if ( var_of( E ) == y )
+      {
+        f01 = then_of( E );
+        f00 = else_of( E );
+      }
+      else
+      {
+        f01 = f00 = E;
+      }
+
+      /* T is regular, hence so are f11 and the new THEN edge. */
+      index_t const new_T = ref( unique( x, f11, f01 ) );
+      index_t const new_E = ref( unique( x, f10, f00 ) );
+      deref_and_free( T );
+      deref_and_free( E );
+
+      nodes[n].v = y;
+      nodes[n].T = new_T;
+      nodes[n].E = new_E;
+      subtable_insert( unique_table[y], hash_children( new_T, new_E ), n );
+    }
+  }
+
+  /* Sift variable `var` through all levels and leave it at the level where the BDDs are the smallest.
+   * Stop moving in one direction when the size exceeds `reorder_max_growth` times the best size so far. */
+  void sift_variable( var_t var, std::chrono::steady_clock::time_point start, Reorder_Stats& stats )
+  {
+    uint32_t const bottom = num_vars() - 1u;
+    uint32_t level = var2level[var];
+    uint32_t best_level = level;
+    uint64_t best_size = num_nodes();
+
+    auto const timed_out = [&]() {
+      return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() > reorder_time_limit;
+    };
+    auto const move_to = [&]( uint32_t target, bool bounded ) {
+      while ( level != target )
+      {
+        if ( level < target )
+        {
+          swap_adjacent( level++ );
+        }
+        else
+        {
+          swap_adjacent( --level );
+        }
+        ++stats.num_swaps;
+        if ( !bounded )
+        {
+          continue;
+        }
+        uint64_t const size = num_nodes();
+        if ( size < best_size )
+        {
+          best_size = size;
+          best_level = level;
+        }
+        if ( size > reorder_max_growth * best_size || timed_out() )
+        {
+          break;
+        }
+      }
+    };
+
+    /* Go to the closer end first. */
+    if ( level > bottom / 2u )
+    {
+      move_to( bottom, true );
+      if ( !timed_out() )
+      {
+        move_to( 0u, true );
+      }
+    }
+    else
+    {
+      move_to( 0u, true );
+      if ( !timed_out() )
+      {
+        move_to( bottom, true );
+      }
+    }
+    move_to( best_level, false );
+  }
+
+  /* `f` rotated left by `shift` bits (0 < `shift` < 64) as a 64-bit word. For indices of up to 64 - `shift` bits,
+   * this is a plain shift, so the bits of two indices combined with it do not overlap. */
+  static uint64_t rotate_index( index_t f, uint32_t shift )
+  {
+    return uint64_t( f ) << shift | uint64_t( f ) >> ( 64u - shift );
+  }
+
+  /* Hash of the children pair of a node (MurmurHash3 finalizer). */
+  static uint64_t hash_children( index_t T, index_t E )
+  {
+    uint64_t k = rotate_index( T, 32u ) ^ E;
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33;
+    return k;
+  }
+
+  /* Find the node with children `T` and `E` in `table`. Return its index, or 0 if it does not exist. */
+  index_t subtable_find( Subtable& table, uint64_t hash, index_t T, index_t E )
+  {
+    ++table.num_lookups;
+    index_t const n = chain_find( table.buckets[hash & ( table.buckets.size() - 1u )], 0u, T, E, table.num_probes );
+    if ( n != 0u )
+    {
+      return n;
+    }
+
+    /* During a resize, the chain may not have been migrated yet. */
+    if ( !table.old_buckets.empty() )
+    {
+      uint64_t const b = hash & ( table.old_buckets.size() - 1u );
+      if ( b >= table.num_migrated )
+      {
+        return chain_find( table.old_buckets[b], 0u, T, E, table.num_probes );
+      }
+    }
+    return 0u;
+  }
+
+  /* Insert node `n` into `table`, growing it when the load factor exceeds 1. */
+  void subtable_insert( Subtable& table, uint64_t hash, index_t n )
+  {
+    index_t& head = table.buckets[hash & ( table.buckets.size() - 1u )];
+    nodes[n].next = head;
+    head = n;
+    ++table.num_entries;
+
+    if ( !table.old_buckets.empty() )
+    {
+      subtable_migrate( table, migration_step );
+    }
+    else if ( table.num_entries > table.buckets.size() )
+    {
+      /* The old chains are moved over by the following insertions, which finish before the table fills up again. */
+      subtable_start_resize( table );
+    }
+  }
+
+  /* Double the bucket array of `table`; its chains are then in `old_buckets`, waiting to be migrated. */
+  void subtable_start_resize( Subtable& table )
+  {
+    assert( table.old_buckets.empty() );
+    table.old_buckets.swap( table.buckets );
+    table.buckets.assign( table.old_buckets.size() * 2u, 0u );
+    table.num_migrated = 0u;
+  }
+
+  /* Move (at most) `num_buckets` old buckets of `table` into the current bucket array. */
+  void subtable_migrate( Subtable& table, uint64_t num_buckets )
+  {
+    uint64_t const mask = table.buckets.size() - 1u;
+    uint64_t const end = std::min<uint64_t>( table.num_migrated + num_buckets, table.old_buckets.size() );
+    for ( ; table.num_migrated < end; ++table.num_migrated )
+    {
+      index_t n = table.old_buckets[table.num_migrated];
+      while ( n != 0u )
+      {
+        index_t const next = nodes[n].next;
+        index_t& head = table.buckets[hash_children( nodes[n].T, nodes[n].E ) & mask];
+        nodes[n].next = head;
+        head = n;
+        n = next;
+      }
+    }
+    if ( table.num_migrated == table.old_buckets.size() )
+    {
+      std::vector<index_t>().swap( table.old_buckets );
+      table.num_migrated = 0u;
+    }
+  }
+
+  /* Unlink node `n` from `table`. */
+  void subtable_remove( Subtable& table, index_t n )
+  {
+    uint64_t const hash = hash_children( nodes[n].T, nodes[n].E );
+    index_t* link = &table.buckets[hash & ( table.buckets.size() - 1u )];
+    while ( *link != 0u && *link != n )
+    {
+      link = &nodes[*link].next;
+    }
+    if ( *link == 0u )
+    {
+      /* Not migrated yet. */
+      assert( !table.old_buckets.empty() );
+      link = &table.old_buckets[hash & ( table.old_buckets.size() - 1u )];
+      while ( *link != n )
+      {
+        assert( *link != 0u && "The node is not in the table." );
+        link = &nodes[*link].next;
+      }
+    }
+    *link = nodes[n].next;
+    --table.num_entries;
+  }
+
+  /* Complete an ongoing resize of `table`. */
+  void subtable_finish_resize( Subtable& table )
+  {
+    if ( !table.old_buckets.empty() )
+    {
+      subtable_migrate( table, table.old_buckets.size() );
+    }
+  }
+
+  /* Get the variable of the node pointed to by edge `f`. */
+  var_t var_of( index_t f ) const
+  {
+    return nodes[f >> 1].v;
+  }
+
+  /* Get the level of the node pointed to by edge `f`. */
+  uint32_t level_of( index_t f ) const
+  {
+    return var2level[nodes[f >> 1].v];
+  }
+
+  /* Get the positive cofactor of edge `f` with respect to its own variable. */
+  index_t then_of( index_t f ) const
+  {
+    return nodes[f >> 1].T ^ ( f & 1u );
+  }
+
+  /* Get the negative cofactor of edge `f` with respect to its own variable. */
+  index_t else_of( index_t f ) const
+  {
+    return nodes[f >> 1].E ^ ( f & 1u );
+  }
+
+  /* Whether edge `c` is a cube of positive literals (the constant 1 being the empty cube). */
+  bool is_cube( index_t c ) const
+  {
+    for ( ; c != constant( true ); c = then_of( c ) )
+    {
+      if ( c == constant( false ) || else_of( c ) != constant( false ) )
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /* A substitution keeping every variable, marked with `no_substitution`. */
+  std::vector<index_t> identity_substitution() const
+  {
+    return std::vector<index_t>( num_vars(), index_t( no_substitution ) );
+  }
+
+  /* Substitute `by_var[v]` for every variable `v` of `f` (except those mapped to `no_substitution`) in one bottom-up
+   * pass over the nodes of `f`, each node being computed once. The nodes below the substituted variables are kept.
+   * If the substitution renames the support of `f` into variables in the same order, the nodes are rebuilt directly;
+   * otherwise they are combined with ITE. */
+  index_t substitute( index_t f, std::vector<index_t> const& by_var )
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    for ( index_t const g : by_var )
+    {
+      if ( g != no_substitution )
+      {
+        ref( g );
+      }
+    }
+    prepare_operation( f, constant( false ) );
+    ref( f );
+
+    /* The levels must stay put during the pass. */
+    bool const reorder = auto_reorder;
+    auto_reorder = false;
+
+    if ( tt_slot.size() < nodes.size() )
+    {
+      tt_slot.resize( nodes.size(), index_t( no_slot ) );
+    }
+    std::vector<index_t> order;
+    collect_reachable( f >> 1, order );
+    std::sort( order.begin(), order.end(), [&]( index_t a, index_t b ) { return var2level[nodes[a].v] > var2level[nodes[b].v]; } );
+
+    /* The variable each variable of the support is renamed into, or `num_vars()` if it is not a renaming. */
+    auto const renamed = [&]( var_t v ) -> uint32_t {
+      index_t const g = by_var[v];
+      if ( g == no_substitution )
+      {
+        return v;
+      }
+      bool const positive_literal = g > constant( true ) && then_of( g ) == constant( true ) && else_of( g ) == constant( false );
+      return positive_literal ? var_of( g ) : num_vars();
+    };
+
+    /* Find the lowest substituted level, and whether the support is renamed in order. */
+    uint32_t bottom = 0u;
+    bool renaming = true;
+    for ( std::size_t i = 0u; i < order.size(); ++i )
+    {
+      var_t const v = nodes[order[i]].v;
+      if ( by_var[v] != no_substitution && bottom == 0u )
+      {
+        bottom = var2level[v] + 1u;
+      }
+      if ( renaming && ( i == 0u || v != nodes[order[i - 1u]].v ) )
+      {
+        var_t const w = renamed( v );
+        renaming = w != num_vars() && ( i == 0u || var2level[w] < var2level[renamed( nodes[order[i - 1u]].v )] );
+      }
+    }
+
+    /* Children first (deepest level first). */
+    std::vector<index_t> results( order.size() );
+    for ( std::size_t i = 0u; i < order.size(); ++i )
+    {
+      tt_slot[order[i]] = i;
+    }
+    auto const result_of = [&]( index_t e ) {
+      return ( e >> 1 ) == 0u ? e : results[tt_slot[e >> 1]] ^ ( e & 1u );
+    };
+    for ( std::size_t i = 0u; i < order.size(); ++i )
+    {
+      Node const n = nodes[order[i]];
+      if ( var2level[n.v] >= bottom )
+      {
+        results[i] = order[i] << 1;
+      }
+      else if ( renaming )
+      {
+        results[i] = unique( renamed( n.v ), result_of( n.T ), result_of( n.E ) );
+      }
+      else
+      {
+        index_t const g = by_var[n.v] == no_substitution ? literal( n.v ) : by_var[n.v];
+        results[i] = ref( ITE( g, result_of( n.T ), result_of( n.E ) ) );
+      }
+    }
+    index_t const r = ref( ( f >> 1 ) == 0u ? f : results.back() ^ ( f & 1u ) );
+
+    for ( std::size_t i = 0u; i < order.size(); ++i )
+    {
+      tt_slot[order[i]] = no_slot;
+      if ( !renaming && var2level[nodes[order[i]].v] < bottom )
+      {
+        deref( results[i] );
+      }
+    }
+    auto_reorder = reorder;
+    deref( f );
+    for ( index_t const g : by_var )
+    {
+      if ( g != no_substitution )
+      {
+        deref( g );
+      }
+    }
+    deref( r );
+    return r;
+  }
+
+  /* Recursive part of `from_tt`. `tt` is a function of the variables in `remaining` (in increasing order),
+   * which are all at level `level` or below. `built` stores the result of each sub-table per level. */
+  index_t from_tt_rec( Truth_Table const& tt, uint32_t level, std::vector<var_t>& remaining,
+                       std::vector<std::unordered_map<Truth_Table, index_t, Truth_Table_Hash>>& built )
+  {
+    /* Only build functions with f(0, ..., 0) = 0; the other ones are complemented edges. */
+    if ( tt.get_bit( 0u ) )
+    {
+      return from_tt_rec( ~tt, level, remaining, built ) ^ 1u;
+    }
+    if ( tt.is_zero() )
+    {
+      return constant( false );
+    }
+
+    /* Skip the levels of variables the table does not have. */
+    while ( !std::binary_search( remaining.begin(), remaining.end(), level2var[level] ) )
+    {
+      ++level;
+    }
+    auto const it = built[level].find( tt );
+    if ( it != built[level].end() )
+    {
+      return it->second;
+    }
+
+    var_t const x = level2var[level];
+    auto const pos = std::lower_bound( remaining.begin(), remaining.end(), x ) - remaining.begin();
+    remaining.erase( remaining.begin() + pos );
+    index_t const r1 = from_tt_rec( tt.shrink_cofactor( pos, true ), level + 1u, remaining, built );
+    index_t const r0 = from_tt_rec( tt.shrink_cofactor( pos, false ), level + 1u, remaining, built );
+    remaining.insert( remaining.begin() + pos, x );
+
+    index_t const r = unique( x, r1, r0 );
+    built[level].emplace( tt, r );
+    return r;
+  }
+
+  /* Push the nodes reachable from node (not edge) `n` that have no truth table slot yet. */
+  void collect_reachable( index_t n, std::vector<index_t>& reachable ) const
+  {
+    if ( n == 0u || tt_slot[n] != no_slot )
+    {
+      return;
+    }
+    tt_slot[n] = 0u;
+    std::size_t i = reachable.size();
+    reachable.emplace_back( n );
+    for ( ; i < reachable.size(); ++i )
+    {
+      for ( index_t const child : { nodes[reachable[i]].T >> 1, nodes[reachable[i]].E >> 1 } )
+      {
+        if ( child != 0u && tt_slot[child] == no_slot )
+        {
+          tt_slot[child] = 0u;
+          reachable.emplace_back( child );
+        }
+      }
+    }
+  }
+
+  /* Count the paths from `f` to the constant true, weighting a path by the number of minterms it covers
+   * (over all the variables) if `minterms` is set. Every node reachable from `f` is visited once, children first.
+   * A node keeps the counts of both its function and its complement, so a complemented edge just picks the other one.
+   * The minterms of x T + x' E are half the sum of those of T and E, as T and E do not depend on x;
+   * both counts are at most 2^num_vars, and take `width` words in `tt_scratch`. */
+  Big_Uint count_paths( index_t f, bool minterms ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    uint64_t const width = num_vars() / 64u + 1u;
+
+    std::vector<index_t>& reachable = tt_nodes;
+    reachable.clear();
+    if ( tt_slot.size() < nodes.size() )
+    {
+      tt_slot.resize( nodes.size(), index_t( no_slot ) );
+    }
+    collect_reachable( f >> 1, reachable );
+    std::sort( reachable.begin(), reachable.end(), [this]( index_t a, index_t b ) {
+      return var2level[nodes[a].v] > var2level[nodes[b].v];
+    } );
+
+    /* The constant node (false) comes last, after the reachable nodes. */
+    uint64_t const total_words = 2u * width * ( reachable.size() + 1u );
+    if ( tt_scratch.size() < total_words )
+    {
+      tt_scratch.resize( total_words );
+    }
+    uint64_t* const constant_counts = &tt_scratch[2u * width * reachable.size()];
+    std::fill( constant_counts, constant_counts + 2u * width, 0u );
+    constant_counts[width + ( minterms ? num_vars() / 64u : 0u )] = uint64_t( 1 ) << ( minterms ? num_vars() % 64u : 0u );
+    auto const counts = [&]( index_t e ) {
+      uint64_t const* const node_counts = ( e >> 1 ) == 0u ? constant_counts : &tt_scratch[2u * width * tt_slot[e >> 1]];
+      return node_counts + ( is_complemented( e ) ? width : 0u );
+    };
+
+    for ( auto i = 0u; i < reachable.size(); ++i )
+    {
+      tt_slot[reachable[i]] = i;
+      Node const& N = nodes[reachable[i]];
+      for ( index_t const c : { 0u, 1u } )
+      {
+        uint64_t const* const t = counts( N.T ^ c );
+        uint64_t const* const e = counts( N.E ^ c );
+        uint64_t* const r = &tt_scratch[2u * width * i + c * width];
+        uint64_t carry = 0u;
+        for ( uint64_t w = 0u; w < width; ++w )
+        {
+          uint64_t const sum = t[w] + e[w];
+          r[w] = sum + carry;
+          carry = ( sum < t[w] ) || ( r[w] < sum );
+        }
+        if ( minterms )
+        {
+          for ( uint64_t w = 0u; w < width; ++w )
+          {
+            r[w] = ( r[w] >> 1 ) | ( ( w + 1u < width ? r[w + 1u] : carry ) << 63 );
+          }
+        }
+        assert( carry == 0u || minterms );
+      }
+    }
+
+    uint64_t const* const r = counts( f );
+    Big_Uint count( std::vector<uint64_t>( r, r + width ) );
+    for ( index_t const m : reachable )
+    {
+      tt_slot[m] = no_slot;
+    }
+    return count;
+  }
+
+  /* Get word `w` of the table of edge `f` seen from a parent of rank `parent_rank` in `get_tt`:
+   * a table of f has variable 0 for the support variable of its own rank, the parent has it `d` variables lower. */
+  uint64_t tt_expanded_word( index_t f, uint32_t parent_rank, std::vector<uint32_t> const& rank, uint64_t w ) const
+  {
+    uint64_t const flip = is_complemented( f ) ? ~uint64_t( 0 ) : 0u;
+    if ( ( f >> 1 ) == 0u )
+    {
+      return flip;
+    }
+    uint64_t const* const words = &tt_scratch[tt_offsets[tt_slot[f >> 1]]];
+    uint32_t const d = rank[level_of( f )] - parent_rank;
+    if ( d >= 6u )
+    {
+      /* the whole word shares one bit of f */
+      uint64_t const i = ( w << 6 ) >> d;
+      return ( ( ( words[i >> 6] >> ( i & 63u ) ) & 1u ) ? ~uint64_t( 0 ) : 0u ) ^ flip;
+    }
+    uint64_t const i = w << ( 6u - d );
+    return tt_kernels::expand_bits( words[i >> 6] >> ( i & 63u ), d ) ^ flip;
+  }
+
+  /* Format edge `f` as the node index, prefixed with `~` if complemented. */
+  static std::string edge_to_string( index_t f )
+  {
+    return ( is_complemented( f ) ? "~" : "" ) + std::to_string( f >> 1 );
+  }
+
+  /* Slot of the computed table holding the key (op, f, g, h). */
+  uint64_t cache_slot( Op op, index_t f, index_t g, index_t h ) const
+  {
+    uint64_t k = ( rotate_index( f, 32u ) ^ g ) * 0x9e3779b97f4a7c15ull;
+    k ^= ( rotate_index( h, 8u ) ^ static_cast<uint32_t>( op ) ) * 0xc2b2ae3d27d4eb4full;
+    k ^= k >> 29;
+    k *= 0xbf58476d1ce4e5b9ull;
+    k ^= k >> 32;
+    return k & cache_mask;
+  }
+
+  /* Look up (op, f, g, h) in the computed table. On a hit, store the result into `r`.
+   * With `concurrent`, the entry is read as a seqlock: a read overlapping a write is a miss.
+   * (The GCC atomic builtins access the plain fields shared with the sequential operations.) */
+  template<bool concurrent>
+  bool cache_lookup( Apply_Context& ctx, Op op, index_t f, index_t g, index_t h, index_t& r )
+  {
+    Computed_Entry const& entry = cache[cache_slot( op, f, g, h )];
+    Cache_Stats& stats = ctx.cache_stats[static_cast<uint32_t>( op )];
+    bool hit;
+    if ( concurrent )
     {
-      n += num_nodes_rec( F.E, visited );
-      visited[F.E] = true;
+      uint32_t const seq = __atomic_load_n( &entry.seq, __ATOMIC_ACQUIRE );
+      hit = ( seq & 1u ) == 0u && __atomic_load_n( &entry.op, __ATOMIC_RELAXED ) == static_cast<uint32_t>( op ) &&
+            __atomic_load_n( &entry.f, __ATOMIC_RELAXED ) == f && __atomic_load_n( &entry.g, __ATOMIC_RELAXED ) == g &&
+            __atomic_load_n( &entry.h, __ATOMIC_RELAXED ) == h;
+      r = __atomic_load_n( &entry.r, __ATOMIC_RELAXED );
+      __atomic_thread_fence( __ATOMIC_ACQUIRE );
+      hit = hit && __atomic_load_n( &entry.seq, __ATOMIC_RELAXED ) == seq;
+    }
+    else
+    {
+      hit = entry.op == static_cast<uint32_t>( op ) && entry.f == f && entry.g == g && entry.h == h;
+      r = entry.r;
+    }
+    if ( hit )
+    {
+      ++stats.hits;
+    }
+    else
+    {
+      ++stats.misses;
+    }
+    return hit;
+  }
+
+  /* Store the result `r` of (op, f, g, h), overwriting whatever occupies the slot.
+   * With `concurrent`, the insertion is dropped if another thread is writing the entry. */
+  template<bool concurrent>
+  void cache_insert( Apply_Context& ctx, Op op, index_t f, index_t g, index_t h, index_t r )
+  {
+    Computed_Entry& entry = cache[cache_slot( op, f, g, h )];
+    uint32_t seq = concurrent ? __atomic_load_n( &entry.seq, __ATOMIC_RELAXED ) : entry.seq;
+    if ( concurrent )
+    {
+      if ( ( seq & 1u ) != 0u ||
+           !__atomic_compare_exchange_n( &entry.seq, &seq, seq + 1u, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) )
+      {
+        return;
+      }
+      seq += 2u;
+    }
+    if ( entry.op != empty_entry )
+    {
+      ++ctx.cache_stats[static_cast<uint32_t>( op )].evictions;
+    }
+    if ( concurrent )
+    {
+      __atomic_store_n( &entry.f, f, __ATOMIC_RELAXED );
+      __atomic_store_n( &entry.g, g, __ATOMIC_RELAXED );
+      __atomic_store_n( &entry.h, h, __ATOMIC_RELAXED );
+      __atomic_store_n( &entry.op, static_cast<uint32_t>( op ), __ATOMIC_RELAXED );
+      __atomic_store_n( &entry.r, r, __ATOMIC_RELAXED );
+      __atomic_store_n( &entry.seq, seq, __ATOMIC_RELEASE );
+    }
+    else
+    {
+      entry = Computed_Entry({f, g, h, static_cast<uint32_t>( op ), r, seq});
     }
-    return n + 1u;
   }
 
 private:
-  std::vector<Node> nodes;
-  std::vector<std::unordered_map<std::pair<index_t, index_t>, index_t>> unique_table;
-  /* `unique_table` is a vector of `num_vars` maps storing the built nodes of each variable.
-   * Each map maps from a pair of node indices (T, E) to a node index, if it exists.
+  Chunked_Array<Node, 20u> nodes;
+  /* `nodes` stores the non-complemented version of every node. Edges refer to it as `index << 1 | complement`.
+   * Its chunks of 2^20 nodes never move, so `Node` references stay valid while nodes are added. */
+
+  std::vector<Subtable> unique_table;
+  /* `unique_table` is a vector of `num_vars` subtables storing the built nodes of each variable.
+   * Each subtable maps from a pair of edges (T, E) to a node index, if it exists.
    * See the implementation of `unique` for example usage. */
 
-  /* statistics */
-  uint64_t num_invoke_not, num_invoke_and, num_invoke_or, num_invoke_xor, num_invoke_ite;
+  std::vector<uint32_t> var2level; /* level of each variable, with `var2level[num_vars] = num_vars` */
+  std::vector<var_t> level2var; /* variable at each level, with `level2var[num_vars] = num_vars` */
+
+  index_t free_list;
+  /* `free_list` is the first freed node (0 if there is none). The freed nodes are chained through `E`. */
+
+  uint64_t num_allocated; /* number of nodes in use (living or dead), excluding constants */
+  uint64_t num_dead; /* number of dead nodes not yet freed */
+  double gc_dead_ratio;
+  uint64_t gc_min_nodes;
+  std::vector<index_t> ref_stack; /* scratch stack of `ref` and `deref` */
+
+  double reorder_max_growth;
+  double reorder_time_limit; /* in seconds */
+  bool auto_reorder;
+  double auto_reorder_growth;
+  uint64_t auto_reorder_min_nodes;
+  uint64_t next_reorder; /* number of living nodes triggering the next automatic reordering */
+  Reorder_Stats last_reorder;
+  std::vector<index_t> swap_scratch; /* nodes being rewritten by `swap_adjacent` */
+
+  std::vector<Apply_Context> contexts; /* one per thread */
+  std::unique_ptr<Work_Stealing_Pool<Apply_Task>> pool; /* threads of the parallel operations, if more than 1 */
+  std::atomic<uint64_t> parallel_next_node; /* next node allocated by a parallel operation */
+  std::atomic<bool> parallel_abort; /* set when a parallel operation runs out of nodes or of unique table space */
+  uint64_t parallel_reserve; /* number of nodes reserved for each parallel operation */
+
+  static constexpr index_t no_substitution = std::numeric_limits<index_t>::max(); /* variable kept by `substitute` */
+
+  /* scratch data of the traversals (`get_tt`, `evaluate`, `num_nodes`, `support`, the counts and `substitute`),
+   * kept to be reused by the next call */
+  static constexpr index_t no_slot = std::numeric_limits<index_t>::max();
+  mutable std::vector<index_t> tt_slot; /* position of each node in `tt_nodes`, or `no_slot` */
+  mutable std::vector<index_t> tt_nodes;
+  /* offset in `tt_scratch` of the table of each node of `tt_nodes` (the blocks of its children in `evaluate`) */
+  mutable std::vector<uint64_t> tt_offsets;
+  mutable Truth_Table::word_vector tt_scratch;
+
+  std::vector<Computed_Entry> cache;
+  uint64_t cache_mask;
+  /* `cache` is the computed table: a direct-mapped, lossy table of 2^k entries shared by all operators.
+   * A colliding insertion simply overwrites the previous entry. */
+
+  /* statistics (see `stats`) */
+  uint64_t num_invoke_not; /* the other operators count in `contexts` */
+  std::chrono::steady_clock::time_point construction_time;
+  uint64_t num_created; /* nodes created */
+  uint64_t peak_allocated; /* maximum of `num_allocated` */
+  uint64_t num_gc;
+  uint64_t gc_freed_nodes;
+  double gc_seconds;
+  double gc_max_pause;
+  uint64_t num_reorders;
+  uint64_t reorder_swaps;
+  double reorder_seconds;
+  std::function<void( Stats const& )> stats_callback; /* see `set_stats_callback` */
+  double stats_interval;
+  std::chrono::steady_clock::time_point next_stats_report;
 };
+
+/* the default manager: 32-bit edges and variables */
+using BDD = Basic_BDD<>;
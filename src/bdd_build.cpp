@@ -0,0 +1,104 @@
+#include "BDD.hpp"
+#include "netlist.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+void usage()
+{
+  cerr << "usage: bdd_build [-r] [-j threads] [-c cache_size_log2] [-o output.bdd] netlist" << endl
+       << "  Build the BDDs of all the outputs of an AIGER (.aag/.aig), BLIF (.blif) or BENCH (.bench) netlist." << endl
+       << "  -r  reorder the variables dynamically" << endl
+       << "  -j  number of threads of the Boolean operations (default 1)" << endl
+       << "  -c  log2 of the number of entries of the computed table (default 20)" << endl
+       << "  -o  save the BDDs of the outputs in the binary format of `BDD::save`" << endl;
+}
+
+int main( int argc, char** argv )
+{
+  bool reorder = false;
+  uint32_t threads = 1u, cache_size_log2 = 20u;
+  string netlist_path, output_path;
+  for ( int i = 1; i < argc; ++i )
+  {
+    string const arg = argv[i];
+    if ( arg == "-r" )
+    {
+      reorder = true;
+    }
+    else if ( ( arg == "-j" || arg == "-c" || arg == "-o" ) && i + 1 < argc )
+    {
+      string const value = argv[++i];
+      if ( arg == "-o" )
+      {
+        output_path = value;
+      }
+      else
+      {
+        ( arg == "-j" ? threads : cache_size_log2 ) = atoi( value.c_str() );
+      }
+    }
+    else if ( arg[0] != '-' && netlist_path.empty() )
+    {
+      netlist_path = arg;
+    }
+    else
+    {
+      usage();
+      return 1;
+    }
+  }
+  if ( netlist_path.empty() || threads == 0u || cache_size_log2 == 0u || cache_size_log2 >= 32u )
+  {
+    usage();
+    return 1;
+  }
+
+  auto const start = chrono::steady_clock::now();
+  Netlist netlist;
+  string error;
+  if ( !read_netlist( netlist_path, netlist, error ) )
+  {
+    cerr << "error: " << error << endl;
+    return 1;
+  }
+  double const parse_seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+
+  BDD bdd( max<size_t>( netlist.inputs.size(), 1u ), cache_size_log2 );
+  bdd.set_num_threads( threads );
+  if ( reorder )
+  {
+    bdd.enable_auto_reorder();
+  }
+  vector<BDD::index_t> outputs;
+  Build_Stats stats;
+  if ( !build_bdds( bdd, netlist, outputs, stats, error ) )
+  {
+    cerr << "error: " << error << endl;
+    return 1;
+  }
+
+  cout << netlist_path << ": " << netlist.inputs.size() - netlist.num_latches << " inputs, "
+       << netlist.outputs.size() - netlist.num_latches << " outputs, " << netlist.num_latches << " latches, "
+       << stats.num_gates << " gates built" << endl;
+  for ( size_t k = 0u; k < outputs.size(); ++k )
+  {
+    cout << "  " << netlist.output_names[k] << ": " << bdd.num_nodes( outputs[k] ) << " nodes" << endl;
+  }
+  bdd.garbage_collect();
+  cout << "shared nodes: " << bdd.num_nodes() << ", peak live nodes: " << stats.peak_live_nodes << endl;
+  cout << fixed << setprecision( 3 ) << "time: " << parse_seconds << " s parsing, " << stats.seconds
+       << " s building" << endl;
+
+  if ( !output_path.empty() && !bdd.save( output_path, outputs ) )
+  {
+    cerr << "error: cannot write " << output_path << endl;
+    return 1;
+  }
+  return 0;
+}
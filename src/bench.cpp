@@ -0,0 +1,678 @@
+#include "BDD.hpp"
+#include "netlist.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <array>
+#include <map>
+#include <unordered_set>
+#include <cstdlib>
+#include <limits>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <sys/resource.h>
+#endif
+#if defined( __GLIBC__ )
+#include <malloc.h>
+#endif
+
+using namespace std;
+
+/* A reproducible performance suite. Every benchmark builds its BDDs in a fresh manager (the best of `repeat` runs
+ * is kept) and reports:
+ *   - `ops`: the number of recursive apply calls (`num_invoke`), or of `unique` calls for the unique table benchmarks,
+ *   - `ops_per_second` and `ns_per_op` (the ns per `unique` call for the unique table benchmarks),
+ *   - `peak_rss_kb`: the peak resident set size during the benchmark (on Linux; elsewhere, of the process so far),
+ *   - `nodes`: the number of nodes of the results, which does not depend on the machine.
+ * The results are written as JSON, one benchmark per line, and compared against a baseline in the same format:
+ * a benchmark regresses when its time or peak memory grows by more than the threshold, or when its node count
+ * changes. */
+
+struct Run
+{
+  uint64_t ops;
+  uint64_t nodes;
+};
+
+struct Result
+{
+  string name;
+  double seconds;
+  uint64_t ops;
+  uint64_t peak_rss_kb;
+  uint64_t nodes;
+};
+
+/**********************************************************/
+/******************** Resident Memory *********************/
+/**********************************************************/
+
+/* Read a field (in kB) of /proc/self/status, or 0 if not available. */
+uint64_t proc_status_kb( string const& field )
+{
+  ifstream status( "/proc/self/status" );
+  string line;
+  while ( getline( status, line ) )
+  {
+    if ( line.compare( 0u, field.size(), field ) == 0 )
+    {
+      return strtoull( line.c_str() + field.size() + 1u, nullptr, 10 );
+    }
+  }
+  return 0u;
+}
+
+/* Restart the peak resident set size measurement from the current size (Linux only),
+ * after giving the memory freed by the previous benchmarks back to the system. */
+void reset_peak_rss()
+{
+#if defined( __GLIBC__ )
+  malloc_trim( 0u );
+#endif
+  ofstream( "/proc/self/clear_refs" ) << "5";
+}
+
+uint64_t peak_rss_kb()
+{
+  uint64_t const peak = proc_status_kb( "VmHWM:" );
+  if ( peak != 0u )
+  {
+    return peak;
+  }
+#if defined( __unix__ ) || defined( __APPLE__ )
+  struct rusage usage;
+  getrusage( RUSAGE_SELF, &usage );
+#if defined( __APPLE__ )
+  return usage.ru_maxrss / 1024u; /* in bytes */
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return 0u;
+#endif
+}
+
+/**********************************************************/
+/*********************** Benchmarks ***********************/
+/**********************************************************/
+
+/* The number of nodes of the referenced results, which are then dereferenced. */
+uint64_t release( BDD& bdd, vector<BDD::index_t> const& results )
+{
+  bdd.garbage_collect();
+  uint64_t const nodes = bdd.num_nodes();
+  for ( auto const f : results )
+  {
+    bdd.deref( f );
+  }
+  return nodes;
+}
+
+/* `per_var` random `unique` calls per variable, bottom-up, with children picked among the results below.
+ * The calls are recorded on a scratch manager: replayed in a fresh manager, they give back the same edges.
+ * The timed replay inserts the nodes, or looks them up if `lookup` (they are inserted before the timer starts). */
+Run unique_table( uint32_t num_vars, uint32_t per_var, bool lookup, function<void()> const& start_timer )
+{
+  vector<array<BDD::index_t, 3>> calls;
+  unordered_set<BDD::index_t> distinct;
+  {
+    BDD scratch( num_vars );
+    mt19937_64 rng( 1u );
+    vector<BDD::index_t> below = { scratch.constant( false ) };
+    for ( uint32_t v = num_vars; v-- > 0u; )
+    {
+      size_t const num_below = below.size();
+      for ( uint32_t i = 0u; i < per_var; ++i )
+      {
+        BDD::index_t const T = below[rng() % num_below], E = below[rng() % num_below] ^ ( rng() & 1u );
+        calls.push_back( { v, T, E } );
+        below.emplace_back( scratch.unique( v, T, E ) );
+        distinct.insert( BDD::regular( below.back() ) );
+      }
+    }
+  }
+
+  BDD bdd( num_vars );
+  for ( uint32_t round = lookup ? 0u : 1u; round < 2u; ++round )
+  {
+    if ( round == 1u )
+    {
+      start_timer();
+    }
+    for ( auto const& call : calls )
+    {
+      bdd.unique( call[0], call[1], call[2] );
+    }
+  }
+  return { calls.size(), distinct.size() - distinct.count( 0u ) };
+}
+
+/* A pool of random functions of `num_vars` variables, repeatedly replaced by AND, XOR or ITE of pool members.
+ * The pool starts with random cubes of 3 literals. The operands and the result of AND get random polarities,
+ * and the constant results are dropped, otherwise the pool would quickly degenerate into constants. */
+Run random_chain( char op, uint32_t num_vars, uint32_t steps )
+{
+  BDD bdd( num_vars, 20u );
+  mt19937_64 rng( 2u );
+  vector<BDD::index_t> pool( 32u );
+  for ( auto& f : pool )
+  {
+    f = bdd.ref( bdd.AND( bdd.literal( rng() % num_vars, rng() & 1u ),
+                          bdd.AND( bdd.literal( rng() % num_vars, rng() & 1u ), bdd.literal( rng() % num_vars, rng() & 1u ) ) ) );
+  }
+  for ( uint32_t i = 0u; i < steps; ++i )
+  {
+    BDD::index_t const f = pool[rng() % pool.size()], g = pool[rng() % pool.size()], h = pool[rng() % pool.size()];
+    BDD::index_t r;
+    if ( op == '&' )
+    {
+      r = bdd.AND( f ^ ( rng() & 1u ), g ^ ( rng() & 1u ) ) ^ ( rng() & 1u );
+    }
+    else if ( op == '^' )
+    {
+      r = bdd.XOR( f, g );
+    }
+    else
+    {
+      r = bdd.ITE( f, g, h );
+    }
+    BDD::index_t& replaced = pool[rng() % pool.size()];
+    if ( BDD::regular( r ) == bdd.constant( false ) )
+    {
+      continue;
+    }
+    bdd.ref( r );
+    bdd.deref( replaced );
+    replaced = r;
+  }
+  return { bdd.num_invoke(), release( bdd, pool ) };
+}
+
+/* The referenced majority and XOR of three referenced functions: a full adder. */
+pair<BDD::index_t, BDD::index_t> full_adder( BDD& bdd, BDD::index_t a, BDD::index_t b, BDD::index_t c )
+{
+  auto const ab = bdd.ref( bdd.XOR( a, b ) );
+  auto const sum = bdd.ref( bdd.XOR( ab, c ) );
+  auto const carry = bdd.ref( bdd.ITE( ab, c, a ) );
+  bdd.deref( ab );
+  return { sum, carry };
+}
+
+/* All the outputs of an n-bit ripple-carry adder, with the operand bits interleaved. */
+Run adder( uint32_t n )
+{
+  BDD bdd( 2u * n );
+  vector<BDD::index_t> outputs;
+  auto carry = bdd.ref( bdd.constant( false ) );
+  for ( uint32_t i = 0u; i < n; ++i )
+  {
+    auto const a = bdd.ref( bdd.literal( 2u * i ) ), b = bdd.ref( bdd.literal( 2u * i + 1u ) );
+    auto const added = full_adder( bdd, a, b, carry );
+    bdd.deref( a ); bdd.deref( b ); bdd.deref( carry );
+    outputs.emplace_back( added.first );
+    carry = added.second;
+  }
+  outputs.emplace_back( carry );
+  return { bdd.num_invoke(), release( bdd, outputs ) };
+}
+
+/* The referenced outputs of an n x n shift-and-add multiplier, with the operand bits interleaved. */
+vector<BDD::index_t> multiplier_outputs( BDD& bdd, uint32_t n )
+{
+  vector<BDD::index_t> product( 2u * n );
+  for ( auto& p : product )
+  {
+    p = bdd.ref( bdd.constant( false ) );
+  }
+  for ( uint32_t i = 0u; i < n; ++i )
+  {
+    auto carry = bdd.ref( bdd.constant( false ) );
+    for ( uint32_t j = 0u; j <= n; ++j )
+    {
+      auto const partial =
+          bdd.ref( j < n ? bdd.AND( bdd.literal( 2u * j ), bdd.literal( 2u * i + 1u ) ) : bdd.constant( false ) );
+      auto const added = full_adder( bdd, product[i + j], partial, carry );
+      bdd.deref( partial ); bdd.deref( carry ); bdd.deref( product[i + j] );
+      product[i + j] = added.first;
+      carry = added.second;
+    }
+    bdd.deref( carry ); /* the product fits in 2n bits */
+  }
+  return product;
+}
+
+Run multiplier( uint32_t n )
+{
+  BDD bdd( 2u * n, 20u );
+  auto const product = multiplier_outputs( bdd, n );
+  return { bdd.num_invoke(), release( bdd, product ) };
+}
+
+/* `rounds` traversals (`num_nodes`) of each output of the multiplier, after renumbering the nodes by level with
+ * `compact` if `compacted`. The operations are the visited nodes. */
+Run traversal( uint32_t n, uint32_t rounds, bool compacted, function<void()> const& restart_timer )
+{
+  BDD bdd( 2u * n, 20u );
+  auto product = multiplier_outputs( bdd, n );
+  if ( compacted )
+  {
+    auto const remap = bdd.compact();
+    for ( auto& p : product )
+    {
+      p = BDD::remap_edge( remap, p );
+    }
+  }
+  restart_timer();
+  uint64_t visited = 0u;
+  for ( uint32_t i = 0u; i < rounds; ++i )
+  {
+    for ( auto const p : product )
+    {
+      visited += bdd.num_nodes( p );
+    }
+  }
+  return { visited, release( bdd, product ) };
+}
+
+/* The N-queens constraints, conjoined row by row and then cell by cell. */
+Run queens( uint32_t n )
+{
+  BDD bdd( n * n, 20u );
+  auto const x = [&]( uint32_t i, uint32_t j ) { return bdd.literal( i * n + j ); };
+  auto f = bdd.ref( bdd.constant( true ) );
+  for ( auto i = 0u; i < n; ++i )
+  {
+    auto row = bdd.ref( bdd.constant( false ) );
+    for ( auto j = 0u; j < n; ++j )
+    {
+      auto const t = bdd.ref( bdd.OR( row, x( i, j ) ) );
+      bdd.deref( row );
+      row = t;
+    }
+    auto const t = bdd.ref( bdd.AND( f, row ) );
+    bdd.deref( f ); bdd.deref( row );
+    f = t;
+  }
+  for ( auto i = 0u; i < n; ++i )
+  {
+    for ( auto j = 0u; j < n; ++j )
+    {
+      auto c = bdd.ref( bdd.constant( true ) );
+      for ( auto k = 0u; k < n; ++k )
+      {
+        for ( auto l = 0u; l < n; ++l )
+        {
+          bool const same = k == i && l == j;
+          if ( !same && ( k == i || l == j || k + j == i + l || k + l == i + j ) )
+          {
+            auto const t = bdd.ref( bdd.DIFF( c, x( k, l ) ) );
+            bdd.deref( c );
+            c = t;
+          }
+        }
+      }
+      auto const imp = bdd.ref( bdd.IMPLIES( x( i, j ), c ) );
+      bdd.deref( c );
+      auto const t = bdd.ref( bdd.AND( f, imp ) );
+      bdd.deref( f ); bdd.deref( imp );
+      f = t;
+    }
+  }
+  return { bdd.num_invoke(), release( bdd, { f } ) };
+}
+
+/* The hidden weighted bit function: x_{k-1} where k is the number of ones among x_0, ..., x_{n-1} (0 if k = 0).
+ * `weight[k]` is built incrementally as "exactly k ones among the variables seen so far". */
+Run hidden_weighted_bit( uint32_t n )
+{
+  BDD bdd( n, 20u );
+  vector<BDD::index_t> weight( n + 1u, bdd.constant( false ) );
+  weight[0] = bdd.constant( true );
+  for ( uint32_t v = n; v-- > 0u; )
+  {
+    for ( uint32_t k = n - v; k > 0u; --k )
+    {
+      auto const t = bdd.ref( bdd.ITE( bdd.literal( v ), weight[k - 1u], weight[k] ) );
+      bdd.deref( weight[k] );
+      weight[k] = t;
+    }
+    auto const t = bdd.ref( bdd.AND( bdd.literal( v, true ), weight[0] ) );
+    bdd.deref( weight[0] );
+    weight[0] = t;
+  }
+  auto f = bdd.ref( bdd.constant( false ) );
+  for ( uint32_t k = 1u; k <= n; ++k )
+  {
+    auto const t = bdd.ref( bdd.OR( f, bdd.AND( weight[k], bdd.literal( k - 1u ) ) ) );
+    bdd.deref( f );
+    f = t;
+  }
+  for ( auto const w : weight )
+  {
+    bdd.deref( w );
+  }
+  return { bdd.num_invoke(), release( bdd, { f } ) };
+}
+
+/* An n x n array multiplier (n >= 2) in the BENCH format, like ISCAS c6288, with the operand bits interleaved.
+ * Row i adds the partial products a_j b_i to the sum bits of row i - 1 shifted by one, with a ripple carry. */
+string array_multiplier_bench( uint32_t n )
+{
+  ostringstream out;
+  for ( uint32_t i = 0u; i < n; ++i )
+  {
+    out << "INPUT(a" << i << ")\nINPUT(b" << i << ")\n";
+  }
+  for ( uint32_t k = 0u; k < 2u * n; ++k )
+  {
+    out << "OUTPUT(p" << k << ")\n";
+  }
+  auto const name = []( char prefix, uint32_t i, uint32_t j ) { return prefix + to_string( i ) + "_" + to_string( j ); };
+  for ( uint32_t j = 0u; j < n; ++j )
+  {
+    out << name( 's', 0u, j ) << " = AND(a" << j << ", b0)\n";
+  }
+  for ( uint32_t i = 1u; i < n; ++i )
+  {
+    for ( uint32_t j = 0u; j < n; ++j )
+    {
+      string const p = name( 'p', i, j ), x = name( 'x', i, j ), s = name( 's', i, j ), c = name( 'c', i, j );
+      out << p << " = AND(a" << j << ", b" << i << ")\n";
+      /* The sum bit above the previous row is its carry out (none for row 0); the first column has no carry in. */
+      string const in = j + 1u < n ? name( 's', i - 1u, j + 1u ) : i > 1u ? name( 'c', i - 1u, n - 1u ) : "";
+      string const carry = j > 0u ? name( 'c', i, j - 1u ) : "";
+      if ( in.empty() || carry.empty() )
+      {
+        string const other = in.empty() ? carry : in;
+        out << s << " = XOR(" << p << ", " << other << ")\n" << c << " = AND(" << p << ", " << other << ")\n";
+      }
+      else
+      {
+        out << x << " = XOR(" << p << ", " << in << ")\n" << s << " = XOR(" << x << ", " << carry << ")\n";
+        out << name( 'g', i, j ) << " = AND(" << p << ", " << in << ")\n";
+        out << name( 'h', i, j ) << " = AND(" << x << ", " << carry << ")\n";
+        out << c << " = OR(" << name( 'g', i, j ) << ", " << name( 'h', i, j ) << ")\n";
+      }
+    }
+  }
+  for ( uint32_t i = 0u; i < n; ++i )
+  {
+    out << "p" << i << " = BUF(" << name( 's', i, 0u ) << ")\n";
+  }
+  for ( uint32_t j = 1u; j < n; ++j )
+  {
+    out << "p" << n - 1u + j << " = BUF(" << name( 's', n - 1u, j ) << ")\n";
+  }
+  out << "p" << 2u * n - 1u << " = BUF(" << name( 'c', n - 1u, n - 1u ) << ")\n";
+  return out.str();
+}
+
+/* Parse a netlist (from `text`, or the file `path` if `text` is empty) and build the BDDs of its outputs. */
+Run netlist( string const& path, string const& text )
+{
+  Netlist netlist;
+  string error;
+  istringstream is( text );
+  if ( !( text.empty() ? read_netlist( path, netlist, error ) : read_bench( is, netlist, error ) ) )
+  {
+    cerr << "error: " << path << ": " << error << endl;
+    exit( 1 );
+  }
+  BDD bdd( max<size_t>( netlist.inputs.size(), 1u ), 20u );
+  vector<BDD::index_t> outputs;
+  Build_Stats stats;
+  if ( !build_bdds( bdd, netlist, outputs, stats, error ) )
+  {
+    cerr << "error: " << path << ": " << error << endl;
+    exit( 1 );
+  }
+  return { bdd.num_invoke(), release( bdd, outputs ) };
+}
+
+/**********************************************************/
+/************************** JSON **************************/
+/**********************************************************/
+
+string json_string( string const& s )
+{
+  string quoted = "\"";
+  for ( char const c : s )
+  {
+    if ( c == '"' || c == '\\' )
+    {
+      quoted += '\\';
+    }
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+void write_json( ostream& os, vector<Result> const& results )
+{
+  os << "{\n  \"version\": 1,\n  \"benchmarks\": [\n" << setprecision( 6 );
+  for ( size_t i = 0u; i < results.size(); ++i )
+  {
+    Result const& r = results[i];
+    os << "    { \"name\": " << json_string( r.name ) << ", \"seconds\": " << r.seconds << ", \"ops\": " << r.ops
+       << ", \"ops_per_second\": " << r.ops / r.seconds << ", \"ns_per_op\": " << r.seconds * 1e9 / max<uint64_t>( r.ops, 1u )
+       << ", \"peak_rss_kb\": " << r.peak_rss_kb << ", \"nodes\": " << r.nodes << " }"
+       << ( i + 1u < results.size() ? "," : "" ) << "\n";
+  }
+  os << "  ]\n}\n";
+}
+
+/* Read the benchmarks of a file written by `write_json` (one benchmark per line). */
+bool read_json( string const& path, map<string, Result>& results )
+{
+  ifstream is( path );
+  if ( !is )
+  {
+    return false;
+  }
+  string line;
+  while ( getline( is, line ) )
+  {
+    size_t pos = line.find( "\"name\": \"" );
+    if ( pos == string::npos )
+    {
+      continue;
+    }
+    Result r;
+    for ( pos += 9u; pos < line.size() && line[pos] != '"'; ++pos )
+    {
+      pos += line[pos] == '\\';
+      r.name += line[pos];
+    }
+    auto const number = [&]( string const& key ) {
+      size_t const at = line.find( "\"" + key + "\": ", pos );
+      return at == string::npos ? 0.0 : strtod( line.c_str() + at + key.size() + 4u, nullptr );
+    };
+    r.seconds = number( "seconds" );
+    r.ops = number( "ops" );
+    r.peak_rss_kb = number( "peak_rss_kb" );
+    r.nodes = number( "nodes" );
+    results[r.name] = r;
+  }
+  return true;
+}
+
+/**********************************************************/
+/************************** Main **************************/
+/**********************************************************/
+
+void usage()
+{
+  cerr << "usage: bdd_bench [-q] [-r repeat] [-o results.json] [-b baseline.json] [-t threshold] [netlist ...]" << endl
+       << "  Run the benchmark suite, and the construction of the given netlists (AIGER, BLIF or BENCH)." << endl
+       << "  -q  quick run with small instances" << endl
+       << "  -r  number of runs of each benchmark, the fastest is kept (default 3)" << endl
+       << "  -o  write the results as JSON" << endl
+       << "  -b  compare against the results of a previous run, and fail on regressions" << endl
+       << "  -t  relative growth of time or peak memory counted as a regression (default 0.2)" << endl;
+}
+
+int main( int argc, char** argv )
+{
+  bool quick = false;
+  uint32_t repeat = 3u;
+  double threshold = 0.2;
+  string output_path, baseline_path;
+  vector<string> netlists;
+  for ( int i = 1; i < argc; ++i )
+  {
+    string const arg = argv[i];
+    if ( arg == "-q" )
+    {
+      quick = true;
+    }
+    else if ( ( arg == "-r" || arg == "-o" || arg == "-b" || arg == "-t" ) && i + 1 < argc )
+    {
+      string const value = argv[++i];
+      if ( arg == "-r" )
+      {
+        repeat = atoi( value.c_str() );
+      }
+      else if ( arg == "-t" )
+      {
+        threshold = atof( value.c_str() );
+      }
+      else
+      {
+        ( arg == "-o" ? output_path : baseline_path ) = value;
+      }
+    }
+    else if ( arg[0] != '-' )
+    {
+      netlists.emplace_back( arg );
+    }
+    else
+    {
+      usage();
+      return 1;
+    }
+  }
+  if ( repeat == 0u || threshold <= 0.0 )
+  {
+    usage();
+    return 1;
+  }
+
+  /* A benchmark may restart the timer to leave out its setup. */
+  using Benchmark = function<Run( function<void()> const& restart_timer )>;
+  auto const size = [&]( uint32_t full, uint32_t small ) { return quick ? small : full; };
+  uint32_t const unique_per_var = size( 1u << 15, 1u << 10 ), and_steps = size( 200000u, 10000u );
+  uint32_t const xor_steps = size( 1500u, 500u ), chain_steps = size( 4000u, 500u );
+  uint32_t const adder_n = size( 512u, 64u ), multiplier_n = size( 10u, 6u ), queens_n = size( 8u, 6u );
+  uint32_t const hwb_n = size( 20u, 12u ), array_n = size( 10u, 6u );
+  vector<pair<string, Benchmark>> benchmarks = {
+      { "unique/insert-" + to_string( unique_per_var ),
+        [&]( function<void()> const& t ) { return unique_table( 64u, unique_per_var, false, t ); } },
+      { "unique/lookup-" + to_string( unique_per_var ),
+        [&]( function<void()> const& t ) { return unique_table( 64u, unique_per_var, true, t ); } },
+      { "apply/and-chain-" + to_string( and_steps ),
+        [&]( function<void()> const& ) { return random_chain( '&', 24u, and_steps ); } },
+      { "apply/xor-chain-" + to_string( xor_steps ),
+        [&]( function<void()> const& ) { return random_chain( '^', 24u, xor_steps ); } },
+      { "apply/ite-chain-" + to_string( chain_steps ),
+        [&]( function<void()> const& ) { return random_chain( '?', 24u, chain_steps ); } },
+      { "adder-" + to_string( adder_n ), [&]( function<void()> const& ) { return adder( adder_n ); } },
+      { "multiplier-" + to_string( multiplier_n ), [&]( function<void()> const& ) { return multiplier( multiplier_n ); } },
+      { "traversal/multiplier-" + to_string( multiplier_n ),
+        [&]( function<void()> const& t ) { return traversal( multiplier_n, 20u, false, t ); } },
+      { "traversal/multiplier-" + to_string( multiplier_n ) + "-compacted",
+        [&]( function<void()> const& t ) { return traversal( multiplier_n, 20u, true, t ); } },
+      { to_string( queens_n ) + "-queens", [&]( function<void()> const& ) { return queens( queens_n ); } },
+      { "hwb-" + to_string( hwb_n ), [&]( function<void()> const& ) { return hidden_weighted_bit( hwb_n ); } } };
+  string const array_text = array_multiplier_bench( array_n );
+  benchmarks.emplace_back( "netlist/array-multiplier-" + to_string( array_n ),
+                           [&]( function<void()> const& ) { return netlist( "array multiplier", array_text ); } );
+  for ( auto const& path : netlists )
+  {
+    benchmarks.emplace_back( "netlist/" + path, [path]( function<void()> const& ) { return netlist( path, "" ); } );
+  }
+
+  vector<Result> results;
+  cout << left << setw( 32 ) << "benchmark" << right << setw( 12 ) << "seconds" << setw( 12 ) << "Mops/s"
+       << setw( 10 ) << "ns/op" << setw( 12 ) << "peak kB" << setw( 12 ) << "nodes" << endl;
+  for ( auto const& benchmark : benchmarks )
+  {
+    reset_peak_rss();
+    Result result = { benchmark.first, numeric_limits<double>::infinity(), 0u, 0u, 0u };
+    for ( uint32_t i = 0u; i < repeat; ++i )
+    {
+      auto start = chrono::steady_clock::now();
+      Run const run = benchmark.second( [&]() { start = chrono::steady_clock::now(); } );
+      result.seconds = min( result.seconds, chrono::duration<double>( chrono::steady_clock::now() - start ).count() );
+      result.ops = run.ops;
+      result.nodes = run.nodes;
+    }
+    result.peak_rss_kb = peak_rss_kb();
+    results.emplace_back( result );
+    cout << left << setw( 32 ) << result.name << right << fixed << setprecision( 4 ) << setw( 12 ) << result.seconds
+         << setprecision( 2 ) << setw( 12 ) << result.ops / result.seconds / 1e6 << setprecision( 1 ) << setw( 10 )
+         << result.seconds * 1e9 / max<uint64_t>( result.ops, 1u ) << setw( 12 ) << result.peak_rss_kb << setw( 12 )
+         << result.nodes << endl;
+  }
+
+  if ( !output_path.empty() )
+  {
+    ofstream os( output_path );
+    write_json( os, results );
+    if ( !os )
+    {
+      cerr << "error: cannot write " << output_path << endl;
+      return 1;
+    }
+  }
+
+  if ( baseline_path.empty() )
+  {
+    return 0;
+  }
+  map<string, Result> baseline;
+  if ( !read_json( baseline_path, baseline ) )
+  {
+    cerr << "error: cannot read " << baseline_path << endl;
+    return 1;
+  }
+  /* Runs of less than 10 ms are too noisy to compare their time. */
+  double const min_seconds = 0.01;
+  uint32_t num_regressions = 0u;
+  cout << "compared to " << baseline_path << " (threshold " << setprecision( 0 ) << threshold * 100 << "%):" << endl;
+  for ( auto const& result : results )
+  {
+    auto const it = baseline.find( result.name );
+    if ( it == baseline.end() )
+    {
+      continue;
+    }
+    Result const& base = it->second;
+    double const time_change = result.seconds / base.seconds - 1.0;
+    double const memory_change = base.peak_rss_kb == 0u ? 0.0 : double( result.peak_rss_kb ) / base.peak_rss_kb - 1.0;
+    cout << "  " << left << setw( 30 ) << result.name << right << showpos << setprecision( 1 ) << setw( 8 )
+         << time_change * 100 << "% time" << setw( 8 ) << memory_change * 100 << "% memory" << noshowpos;
+    if ( time_change > threshold && max( result.seconds, base.seconds ) >= min_seconds )
+    {
+      cout << "  REGRESSION (time)";
+      ++num_regressions;
+    }
+    if ( memory_change > threshold && result.peak_rss_kb != 0u )
+    {
+      cout << "  REGRESSION (memory)";
+      ++num_regressions;
+    }
+    if ( result.nodes != base.nodes )
+    {
+      cout << "  CHANGED (" << base.nodes << " nodes before)";
+      ++num_regressions;
+    }
+    cout << endl;
+  }
+  cout << ( num_regressions == 0u ? "no regression" : to_string( num_regressions ) + " regression(s)" ) << endl;
+  return num_regressions == 0u ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* An unsigned integer of arbitrary precision, such as a number of minterms or of paths of a BDD. */
+class Big_Uint
+{
+public:
+  Big_Uint( uint64_t value = 0u )
+   : words( 1u, value )
+  {
+    trim();
+  }
+
+  /* The value given by `words`, 64 bits per word, least significant word first. */
+  explicit Big_Uint( std::vector<uint64_t> words )
+   : words( std::move( words ) )
+  {
+    trim();
+  }
+
+  /* whether the value fits in 64 bits */
+  bool fits_uint64() const
+  {
+    return words.size() <= 1u;
+  }
+
+  uint64_t to_uint64() const
+  {
+    assert( fits_uint64() );
+    return words.empty() ? 0u : words[0];
+  }
+
+  /* the value as a double, rounded (infinity beyond its range) */
+  double to_double() const
+  {
+    if ( words.empty() )
+    {
+      return 0.0;
+    }
+    /* The top two words hold more bits than a double keeps. */
+    double const top = std::ldexp( double( words.back() ), 64 );
+    double const next = words.size() > 1u ? double( words[words.size() - 2u] ) : 0.0;
+    int const exponent = words.size() > 1u ? 64 * int( words.size() - 2u ) : -64;
+    return std::ldexp( top + next, exponent );
+  }
+
+  /* number of significant bits */
+  uint64_t num_bits() const
+  {
+    if ( words.empty() )
+    {
+      return 0u;
+    }
+    uint64_t bits = 64u * ( words.size() - 1u );
+    for ( uint64_t w = words.back(); w != 0u; w >>= 1 )
+    {
+      ++bits;
+    }
+    return bits;
+  }
+
+  Big_Uint& operator+=( Big_Uint const& other )
+  {
+    words.resize( std::max( words.size(), other.words.size() ) + 1u, 0u );
+    uint64_t carry = 0u;
+    for ( auto i = 0u; i < words.size(); ++i )
+    {
+      uint64_t const b = i < other.words.size() ? other.words[i] : 0u;
+      uint64_t const sum = words[i] + b;
+      uint64_t const next_carry = ( sum < b ) || ( sum + carry < sum );
+      words[i] = sum + carry;
+      carry = next_carry;
+    }
+    trim();
+    return *this;
+  }
+
+  Big_Uint& operator<<=( uint64_t shift )
+  {
+    if ( words.empty() )
+    {
+      return *this;
+    }
+    uint64_t const word_shift = shift >> 6;
+    uint32_t const bit_shift = shift & 63u;
+    words.insert( words.begin(), word_shift, 0u );
+    if ( bit_shift != 0u )
+    {
+      words.emplace_back( 0u );
+      for ( auto i = words.size(); i-- > word_shift + 1u; )
+      {
+        words[i] = ( words[i] << bit_shift ) | ( words[i - 1u] >> ( 64u - bit_shift ) );
+      }
+      words[word_shift] <<= bit_shift;
+    }
+    trim();
+    return *this;
+  }
+
+  /* Shift right, dropping the low bits. */
+  Big_Uint& operator>>=( uint64_t shift )
+  {
+    uint64_t const word_shift = shift >> 6;
+    uint32_t const bit_shift = shift & 63u;
+    if ( word_shift >= words.size() )
+    {
+      words.clear();
+      return *this;
+    }
+    words.erase( words.begin(), words.begin() + word_shift );
+    if ( bit_shift != 0u )
+    {
+      for ( auto i = 0u; i + 1u < words.size(); ++i )
+      {
+        words[i] = ( words[i] >> bit_shift ) | ( words[i + 1u] << ( 64u - bit_shift ) );
+      }
+      words.back() >>= bit_shift;
+    }
+    trim();
+    return *this;
+  }
+
+  /* decimal representation */
+  std::string to_string() const
+  {
+    if ( words.empty() )
+    {
+      return "0";
+    }
+    /* Divide by 10^9 repeatedly, 32 bits at a time, collecting 9 digits at a time. */
+    uint64_t const base = 1000000000u;
+    std::vector<uint64_t> quotient( words );
+    std::string digits;
+    while ( !quotient.empty() )
+    {
+      uint64_t remainder = 0u;
+      for ( auto i = quotient.size(); i-- > 0u; )
+      {
+        uint64_t const high = ( remainder << 32 ) | ( quotient[i] >> 32 );
+        uint64_t const low = ( ( high % base ) << 32 ) | ( quotient[i] & 0xffffffffu );
+        quotient[i] = ( ( high / base ) << 32 ) | ( low / base );
+        remainder = low % base;
+      }
+      while ( !quotient.empty() && quotient.back() == 0u )
+      {
+        quotient.pop_back();
+      }
+      std::string chunk = std::to_string( remainder );
+      if ( !quotient.empty() )
+      {
+        chunk.insert( 0u, 9u - chunk.size(), '0' );
+      }
+      digits.insert( 0u, chunk );
+    }
+    return digits;
+  }
+
+private:
+  /* Drop the leading zero words, so that equal values have equal `words`. */
+  void trim()
+  {
+    while ( !words.empty() && words.back() == 0u )
+    {
+      words.pop_back();
+    }
+  }
+
+public:
+  std::vector<uint64_t> words; /* 64 bits per word, least significant word first, without leading zero words */
+};
+
+inline Big_Uint operator+( Big_Uint a, Big_Uint const& b )
+{
+  return a += b;
+}
+
+inline Big_Uint operator<<( Big_Uint a, uint64_t shift )
+{
+  return a <<= shift;
+}
+
+inline Big_Uint operator>>( Big_Uint a, uint64_t shift )
+{
+  return a >>= shift;
+}
+
+inline bool operator==( Big_Uint const& a, Big_Uint const& b )
+{
+  return a.words == b.words;
+}
+
+inline bool operator!=( Big_Uint const& a, Big_Uint const& b )
+{
+  return !( a == b );
+}
+
+inline bool operator<( Big_Uint const& a, Big_Uint const& b )
+{
+  if ( a.words.size() != b.words.size() )
+  {
+    return a.words.size() < b.words.size();
+  }
+  return std::lexicographical_compare( a.words.rbegin(), a.words.rend(), b.words.rbegin(), b.words.rend() );
+}
+
+inline std::ostream& operator<<( std::ostream& os, Big_Uint const& n )
+{
+  return os << n.to_string();
+}
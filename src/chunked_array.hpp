@@ -0,0 +1,162 @@
+#pragma once
+
+#include <vector>
+#include <new>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <type_traits>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <sys/mman.h>
+#endif
+
+/* Backing of the chunks of a `Chunked_Array`. */
+enum class Huge_Pages : uint8_t
+{
+  NONE, /* regular pages */
+  TRANSPARENT, /* regular mappings advised to use transparent huge pages (Linux `MADV_HUGEPAGE`) */
+  EXPLICIT /* `MAP_HUGETLB` from the reserved huge page pool, or TRANSPARENT if it is empty (Linux only) */
+};
+
+/* An array of trivial elements stored in fixed-size chunks of 2^`chunk_log2` elements that never move:
+ * growing allocates new chunks instead of copying, so references to the elements stay valid, and the memory
+ * never peaks above one spare chunk. Element i is at `chunks[i >> chunk_log2][i & mask]`.
+ * Like with `std::vector` of a default-initializing allocator, the elements added by `resize` are not initialized.
+ * On POSIX systems the chunks are mapped anonymously, so their pages only take memory once they are touched. */
+template<typename T, uint32_t chunk_log2>
+class Chunked_Array
+{
+  static_assert( std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                 "The elements are copied and dropped as raw memory." );
+
+public:
+  static constexpr uint64_t chunk_size = uint64_t( 1 ) << chunk_log2;
+
+  Chunked_Array() : num_elements( 0u ), huge_pages( Huge_Pages::NONE )
+  {
+  }
+
+  Chunked_Array( Chunked_Array const& ) = delete;
+  Chunked_Array& operator=( Chunked_Array const& ) = delete;
+
+  ~Chunked_Array()
+  {
+    for ( T* chunk : chunks )
+    {
+      free_chunk( chunk );
+    }
+  }
+
+  T& operator[]( uint64_t i )
+  {
+    assert( i < num_elements );
+    return chunks[i >> chunk_log2][i & ( chunk_size - 1u )];
+  }
+
+  T const& operator[]( uint64_t i ) const
+  {
+    assert( i < num_elements );
+    return chunks[i >> chunk_log2][i & ( chunk_size - 1u )];
+  }
+
+  uint64_t size() const
+  {
+    return num_elements;
+  }
+
+  /* number of elements that fit in the allocated chunks */
+  uint64_t capacity() const
+  {
+    return chunks.size() << chunk_log2;
+  }
+
+  /* Set the backing of the chunks allocated from now on. */
+  void set_huge_pages( Huge_Pages mode )
+  {
+    huge_pages = mode;
+  }
+
+  void emplace_back( T const& element )
+  {
+    if ( num_elements == capacity() )
+    {
+      add_chunk();
+    }
+    ++num_elements;
+    ::new( static_cast<void*>( &( *this )[num_elements - 1u] ) ) T( element );
+  }
+
+  /* Allocate the chunks for `n` elements. */
+  void reserve( uint64_t n )
+  {
+    chunks.reserve( ( n + chunk_size - 1u ) >> chunk_log2 );
+    while ( capacity() < n )
+    {
+      add_chunk();
+    }
+  }
+
+  /* Resize to `n` elements. Shrinking keeps the chunks for later growth. */
+  void resize( uint64_t n )
+  {
+    reserve( n );
+    num_elements = n;
+  }
+
+private:
+  static constexpr std::size_t chunk_bytes = sizeof( T ) << chunk_log2;
+
+  /* Room is made for the pointer first, so that a chunk is never lost to a failing allocation. */
+  void add_chunk()
+  {
+    if ( chunks.size() == chunks.capacity() )
+    {
+      chunks.reserve( 2u * chunks.size() + 1u );
+    }
+    chunks.push_back( allocate_chunk() );
+  }
+
+  T* allocate_chunk() const
+  {
+#if defined( __unix__ ) || defined( __APPLE__ )
+    void* chunk = MAP_FAILED;
+#if defined( MAP_HUGETLB )
+    if ( huge_pages == Huge_Pages::EXPLICIT && chunk_bytes % ( std::size_t( 1 ) << 21 ) == 0u )
+    {
+      chunk = mmap( nullptr, chunk_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+    }
+#endif
+    if ( chunk == MAP_FAILED )
+    {
+      chunk = mmap( nullptr, chunk_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+      if ( chunk == MAP_FAILED )
+      {
+        throw std::bad_alloc();
+      }
+#if defined( MADV_HUGEPAGE )
+      if ( huge_pages != Huge_Pages::NONE )
+      {
+        madvise( chunk, chunk_bytes, MADV_HUGEPAGE );
+      }
+#endif
+    }
+    return static_cast<T*>( chunk );
+#else
+    return static_cast<T*>( ::operator new( chunk_bytes ) );
+#endif
+  }
+
+  static void free_chunk( T* chunk )
+  {
+#if defined( __unix__ ) || defined( __APPLE__ )
+    munmap( chunk, chunk_bytes );
+#else
+    ::operator delete( chunk );
+#endif
+  }
+
+  std::vector<T*> chunks;
+  uint64_t num_elements;
+  Huge_Pages huge_pages;
+};
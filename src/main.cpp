@@ -1,9 +1,12 @@
 #include "BDD.hpp"
 #include "truth_table.hpp"
+#include "reachability.hpp"
+#include "netlist.hpp"
 
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <sstream>
 
 using namespace std;
 
@@ -65,6 +68,26 @@ bool checkEQ( uint64_t actual, uint64_t expected )
   }
 }
 
+/* Build the same functions with a manager of any width, reorder and compact it, and return their truth tables
+ * and the final number of nodes (test 25). */
+template<class Manager>
+std::vector<Truth_Table> build_on( Manager& bdd, uint64_t& size )
+{
+  auto const x = [&]( uint32_t i ) { return bdd.literal( i ); };
+  auto f = bdd.ref( bdd.ITE( x( 0 ), bdd.XOR( x( 1 ), x( 4 ) ), bdd.AND( x( 2 ), bdd.NOT( x( 5 ) ) ) ) );
+  auto g = bdd.ref( bdd.and_exists( f, bdd.OR( x( 3 ), x( 1 ) ), bdd.cube( { false, true, false, false, true } ) ) );
+  bdd.set_num_threads( 2u );
+  auto h = bdd.ref( bdd.XOR( bdd.AND( f, x( 6 ) ), bdd.OR( g, x( 7 ) ) ) );
+  bdd.set_num_threads( 1u );
+  bdd.reorder();
+  auto const remap = bdd.compact();
+  f = Manager::remap_edge( remap, f );
+  g = Manager::remap_edge( remap, g );
+  h = Manager::remap_edge( remap, h );
+  size = bdd.num_nodes();
+  return bdd.get_tt( { f, g, h } );
+}
+
 int main()
 {
   bool passed = true;
@@ -260,6 +283,514 @@ int main()
     passed &= checkLE( bdd.num_invoke(), 10 );
   }
 
+  {
+    cout << "test 09: garbage collection" << endl;
+    BDD bdd( 4 );
+    auto const x0 = bdd.ref( bdd.literal( 0 ) );
+    auto const x1 = bdd.ref( bdd.literal( 1 ) );
+    auto const x2 = bdd.ref( bdd.literal( 2 ) );
+    auto const x3 = bdd.ref( bdd.literal( 3 ) );
+    auto const f = bdd.ref( bdd.AND( bdd.XOR( x0, x1 ), bdd.XOR( x2, x3 ) ) );
+    bdd.deref( x0 ); bdd.deref( x1 ); bdd.deref( x2 ); bdd.deref( x3 );
+    auto const live = bdd.num_nodes();
+    bdd.deref( f );
+
+    cout << "  checking number of freed nodes";
+    passed &= checkEQ( bdd.garbage_collect(), live + 4 );
+    cout << "  checking BDD size (living nodes)";
+    passed &= checkEQ( bdd.num_nodes(), 0 );
+
+    auto const g = bdd.ref( bdd.OR( bdd.literal( 2 ), bdd.literal( 3 ) ) );
+    passed &= check( bdd.get_tt( g ), create_tt_nth_var( 4, 2 ) | create_tt_nth_var( 4, 3 ) );
+    cout << "  checking BDD size (living nodes)";
+    passed &= checkEQ( bdd.num_nodes(), 2 );
+  }
+
+  {
+    cout << "test 10: variable reordering" << endl;
+    BDD bdd( 6 );
+    auto const g1 = bdd.ref( bdd.AND( bdd.literal( 0 ), bdd.literal( 3 ) ) );
+    auto const g2 = bdd.ref( bdd.AND( bdd.literal( 1 ), bdd.literal( 4 ) ) );
+    auto const g3 = bdd.ref( bdd.AND( bdd.literal( 2 ), bdd.literal( 5 ) ) );
+    auto const h = bdd.ref( bdd.OR( g1, g2 ) );
+    bdd.deref( g1 ); bdd.deref( g2 );
+    auto const f = bdd.ref( bdd.OR( h, g3 ) );
+    bdd.deref( h ); bdd.deref( g3 );
+    auto const tt = bdd.get_tt( f );
+
+    auto const stats = bdd.reorder();
+    passed &= check( bdd.get_tt( f ), tt );
+    cout << "  checking BDD size (reachable nodes)";
+    passed &= checkEQ( bdd.num_nodes( f ), 6 );
+    cout << "  checking reported BDD size";
+    passed &= checkEQ( stats.nodes_after, bdd.num_nodes() );
+  }
+
+  {
+    cout << "test 11: BDD from truth table" << endl;
+    BDD bdd( 8 );
+    auto const x0 = bdd.ref( bdd.literal( 0 ) );
+    auto const x3 = bdd.ref( bdd.literal( 3 ) );
+    auto const x7 = bdd.ref( bdd.literal( 7 ) );
+    auto const g = bdd.ref( bdd.ITE( x7, bdd.XOR( x0, x3 ), bdd.NOT( x3 ) ) );
+    bdd.deref( x0 ); bdd.deref( x3 ); bdd.deref( x7 );
+
+    auto const tt = ( create_tt_nth_var( 8, 7 ) & ( create_tt_nth_var( 8, 0 ) ^ create_tt_nth_var( 8, 3 ) ) ) |
+                    ( create_tt_nth_var( 8, 7, false ) & create_tt_nth_var( 8, 3, false ) );
+    auto const f = bdd.ref( bdd.from_tt( tt ) );
+    passed &= check( bdd.get_tt( f ), tt );
+    cout << "  checking canonicity";
+    passed &= checkEQ( f, g );
+  }
+
+  {
+    cout << "test 12: deep BDDs" << endl;
+    uint32_t const n = 100001u;
+    BDD bdd( n );
+    auto parity = bdd.ref( bdd.constant( false ) );
+    auto conjunction = bdd.ref( bdd.constant( true ) );
+    for ( auto i = n; i-- > 0u; )
+    {
+      auto const p = bdd.ref( bdd.XOR( bdd.literal( i ), parity ) );
+      auto const c = bdd.ref( bdd.AND( bdd.literal( i ), conjunction ) );
+      bdd.deref( parity ); bdd.deref( conjunction );
+      parity = p; conjunction = c;
+    }
+
+    /* The only minterm of the conjunction has odd parity: AND recurses along the whole chain. */
+    auto const f = bdd.ref( bdd.AND( parity, conjunction ) );
+    cout << "  checking function correctness";
+    passed &= checkEQ( f, conjunction );
+    cout << "  checking BDD size (reachable nodes)";
+    passed &= checkEQ( bdd.num_nodes( parity ), n );
+  }
+
+  {
+    cout << "test 13: parallel operations" << endl;
+    BDD bdd( 12 );
+    bdd.set_num_threads( 4 );
+    auto f = bdd.ref( bdd.constant( false ) );
+    Truth_Table tt( 12 );
+    for ( auto i = 0u; i < 6u; ++i )
+    {
+      auto const g = bdd.ref( bdd.ITE( bdd.literal( i ), bdd.literal( i + 6 ), bdd.NOT( bdd.literal( 11 - i ) ) ) );
+      auto const h = bdd.ref( bdd.XOR( f, g ) );
+      bdd.deref( f ); bdd.deref( g );
+      f = h;
+      tt = tt ^ ( ( create_tt_nth_var( 12, i ) & create_tt_nth_var( 12, i + 6 ) ) |
+                  ( create_tt_nth_var( 12, i, false ) & create_tt_nth_var( 12, 11 - i, false ) ) );
+    }
+    auto const r = bdd.ref( bdd.AND( f, bdd.OR( bdd.literal( 3 ), bdd.literal( 9 ) ) ) );
+    tt = tt & ( create_tt_nth_var( 12, 3 ) | create_tt_nth_var( 12, 9 ) );
+    passed &= check( bdd.get_tt( r ), tt );
+
+    /* The sequential operation finds the nodes built by the threads. */
+    bdd.set_num_threads( 1 );
+    bdd.clear_cache();
+    cout << "  checking canonicity";
+    passed &= checkEQ( bdd.AND( f, bdd.OR( bdd.literal( 3 ), bdd.literal( 9 ) ) ), r );
+  }
+
+  {
+    cout << "test 14: quantification" << endl;
+    BDD bdd( 4 );
+    auto const g1 = bdd.ref( bdd.AND( bdd.literal( 0 ), bdd.literal( 1 ) ) );
+    auto const g2 = bdd.ref( bdd.AND( bdd.literal( 2 ), bdd.literal( 3 ) ) );
+    auto const f = bdd.ref( bdd.OR( g1, g2 ) );
+    bdd.deref( g1 ); bdd.deref( g2 );
+
+    auto const e = bdd.ref( bdd.exists( f, { false, true, true, false } ) );
+    passed &= check( bdd.get_tt( e ), create_tt_nth_var( 4, 0 ) | create_tt_nth_var( 4, 3 ) );
+    auto const a = bdd.ref( bdd.forall( f, bdd.cube( { false, true, false, false } ) ) );
+    passed &= check( bdd.get_tt( a ), create_tt_nth_var( 4, 2 ) & create_tt_nth_var( 4, 3 ) );
+
+    /* (exists x1) (x0 ^ x1) & (x1 ^ x2) is x0 == x2 */
+    auto const h1 = bdd.ref( bdd.XOR( bdd.literal( 0 ), bdd.literal( 1 ) ) );
+    auto const h2 = bdd.ref( bdd.XOR( bdd.literal( 1 ), bdd.literal( 2 ) ) );
+    auto const p = bdd.ref( bdd.and_exists( h1, h2, bdd.cube( { false, true, false, false } ) ) );
+    passed &= check( bdd.get_tt( p ), ~( create_tt_nth_var( 4, 0 ) ^ create_tt_nth_var( 4, 2 ) ) );
+    cout << "  checking canonicity";
+    passed &= checkEQ( p, bdd.NOT( bdd.XOR( bdd.literal( 0 ), bdd.literal( 2 ) ) ) );
+  }
+
+  {
+    cout << "test 15: reachability" << endl;
+    /* A 3-bit counter modulo 6 with an enable input. State bit k is variable 2k, its next state 2k + 1. */
+    BDD bdd( 7 );
+    auto const b0 = bdd.literal( 0 ), b1 = bdd.literal( 2 ), b2 = bdd.literal( 4 ), enable = bdd.literal( 6 );
+    auto const is5 = bdd.ref( bdd.AND( bdd.AND( b2, bdd.NOT( b1 ) ), b0 ) );
+    auto const carry = bdd.ref( bdd.AND( b1, b0 ) );
+    vector<BDD::index_t> const counted = { bdd.NOT( b0 ), bdd.XOR( b1, b0 ), bdd.XOR( b2, carry ) };
+    vector<BDD::index_t> partitions;
+    for ( auto k = 0u; k < 3u; ++k )
+    {
+      auto const d = bdd.ref( bdd.ITE( enable, bdd.AND( bdd.NOT( is5 ), counted[k] ), bdd.literal( 2 * k ) ) );
+      partitions.emplace_back( bdd.ref( bdd.NOT( bdd.XOR( bdd.literal( 2 * k + 1 ), d ) ) ) );
+      bdd.deref( d );
+    }
+    bdd.deref( is5 ); bdd.deref( carry );
+
+    Reachability reachability( bdd, partitions, { 0, 2, 4 }, { 1, 3, 5 }, { 6 } );
+    auto const zero = bdd.ref( bdd.AND( bdd.AND( bdd.NOT( b0 ), bdd.NOT( b1 ) ), bdd.NOT( b2 ) ) );
+    auto const reached = bdd.ref( reachability.forward_reachable( zero ) );
+    cout << "  checking reachable states";
+    passed &= checkEQ( reached, bdd.NOT( bdd.AND( b2, b1 ) ) );
+    cout << "  checking number of iterations";
+    passed &= checkEQ( reachability.last_stats().iterations.size(), 6 );
+
+    auto const five = bdd.ref( bdd.AND( bdd.AND( b0, bdd.NOT( b1 ) ), b2 ) );
+    cout << "  checking backward reachable states";
+    passed &= checkEQ( reachability.backward_reachable( five ), bdd.constant( true ) );
+  }
+
+  {
+    cout << "test 16: composition" << endl;
+    BDD bdd( 4 );
+    auto const x0 = create_tt_nth_var( 4, 0 ), x1 = create_tt_nth_var( 4, 1 );
+    auto const x2 = create_tt_nth_var( 4, 2 ), x3 = create_tt_nth_var( 4, 3 );
+    auto const f = bdd.ref( bdd.ITE( bdd.literal( 0 ), bdd.literal( 1 ), bdd.XOR( bdd.literal( 2 ), bdd.literal( 3 ) ) ) );
+
+    /* f[x0 := x2 & x3] */
+    auto const c = bdd.ref( bdd.compose( f, 0, bdd.AND( bdd.literal( 2 ), bdd.literal( 3 ) ) ) );
+    passed &= check( bdd.get_tt( c ), ( x2 & x3 & x1 ) | ( ~( x2 & x3 ) & ( x2 ^ x3 ) ) );
+    /* f[x0 := x3, x3 := x0], all at once */
+    auto const s = bdd.ref( bdd.compose( f, { { 0, bdd.literal( 3 ) }, { 3, bdd.literal( 0 ) } } ) );
+    passed &= check( bdd.get_tt( s ), ( x3 & x1 ) | ( ~x3 & ( x2 ^ x0 ) ) );
+    cout << "  checking swap_vars";
+    passed &= checkEQ( bdd.swap_vars( f, 0, 3 ), s );
+
+    /* Shifting the variables up keeps their order: the result has the same shape. */
+    auto const g = bdd.ref( bdd.AND( bdd.literal( 0 ), bdd.OR( bdd.literal( 1 ), bdd.literal( 2 ) ) ) );
+    auto const p = bdd.ref( bdd.permute( g, { 1, 2, 3, 0 } ) );
+    passed &= check( bdd.get_tt( p ), x1 & ( x2 | x3 ) );
+    cout << "  checking number of nodes";
+    passed &= checkEQ( bdd.num_nodes( p ), bdd.num_nodes( g ) );
+  }
+
+  {
+    cout << "test 17: model counting" << endl;
+    BDD bdd( 100 );
+    /* x0 + x1 x2 has 5 minterms over 3 variables and 2 paths to true. */
+    auto const f = bdd.ref( bdd.OR( bdd.literal( 0 ), bdd.AND( bdd.literal( 1 ), bdd.literal( 2 ) ) ) );
+    cout << "  checking number of minterms";
+    passed &= checkEQ( bdd.sat_count( f, 3 ).to_uint64(), 5 );
+    cout << "  checking number of paths";
+    passed &= checkEQ( bdd.path_count( f ).to_uint64(), 2 );
+    cout << "  checking density";
+    passed &= checkEQ( bdd.density( bdd.NOT( f ) ) == 3.0 / 8.0, true );
+
+    /* The parity of 100 variables has 2^99 minterms, each one a path. */
+    auto parity = bdd.ref( bdd.constant( false ) );
+    for ( auto v = 0u; v < 100u; ++v )
+    {
+      auto const t = bdd.ref( bdd.XOR( parity, bdd.literal( v ) ) );
+      bdd.deref( parity );
+      parity = t;
+    }
+    cout << "  checking number of minterms";
+    passed &= checkEQ( bdd.sat_count( parity ) == Big_Uint( 1 ) << 99, true );
+    cout << "  checking number of paths";
+    passed &= checkEQ( bdd.path_count( parity ) == Big_Uint( 1 ) << 99, true );
+  }
+
+  {
+    cout << "test 18: cube enumeration" << endl;
+    BDD bdd( 3 );
+    /* x0 + x1 x2: the paths give the cubes x0 and x0' x1 x2. */
+    auto const f = bdd.ref( bdd.OR( bdd.literal( 0 ), bdd.AND( bdd.literal( 1 ), bdd.literal( 2 ) ) ) );
+    vector<BDD::Cube> cubes;
+    for ( auto const& cube : bdd.cubes( f ) )
+    {
+      cubes.emplace_back( cube );
+    }
+    cout << "  checking cubes";
+    passed &= checkEQ( cubes == vector<BDD::Cube>{ { 1, BDD::dont_care, BDD::dont_care }, { 0, 1, 1 } }, true );
+    cout << "  checking pick_one_cube";
+    passed &= checkEQ( bdd.pick_one_cube( bdd.NOT( f ) ) == BDD::Cube{ 0, 1, 0 }, true );
+
+    mt19937 rng( 1 );
+    bool satisfied = true;
+    for ( auto i = 0u; i < 20u; ++i )
+    {
+      auto const m = bdd.pick_random_minterm( f, rng );
+      satisfied &= m[0] || ( m[1] && m[2] );
+    }
+    cout << "  checking random minterms";
+    passed &= checkEQ( satisfied, true );
+  }
+
+  {
+    cout << "test 19: bit-parallel evaluation" << endl;
+    BDD bdd( 6 );
+    auto const g = bdd.ref( bdd.AND( bdd.literal( 1 ), bdd.NOT( bdd.literal( 5 ) ) ) );
+    auto const f = bdd.ref( bdd.XOR( bdd.OR( bdd.literal( 0 ), g ), bdd.literal( 3 ) ) );
+    /* The 64 patterns enumerating the 6 variables give back the truth table. */
+    vector<uint64_t> const patterns( var_mask_pos, var_mask_pos + 6 );
+    cout << "  checking the 64 patterns";
+    passed &= checkEQ( bdd.evaluate( f, patterns ), bdd.get_tt( f ).bits[0] );
+
+    /* Two words per variable: the same patterns, then their complements. */
+    vector<uint64_t> wide, complemented;
+    for ( auto const word : patterns )
+    {
+      wide.insert( wide.end(), { word, ~word } );
+      complemented.emplace_back( ~word );
+    }
+    auto const results = bdd.evaluate( vector<BDD::index_t>{ f, g }, wide, 2u );
+    cout << "  checking several roots and words";
+    passed &= checkEQ( results[0] == bdd.get_tt( f ).bits[0] && results[1] == bdd.evaluate( f, complemented ) &&
+                       results[2] == bdd.get_tt( g ).bits[0] && results[3] == bdd.evaluate( g, complemented ), true );
+  }
+
+  {
+    cout << "test 20: serialization" << endl;
+    BDD bdd( 4 );
+    auto const x = bdd.ref( bdd.XOR( bdd.literal( 0 ), bdd.literal( 3 ) ) );
+    auto const f = bdd.ref( bdd.ITE( bdd.literal( 2 ), x, bdd.literal( 1 ) ) );
+    auto const g = bdd.ref( bdd.AND( f, bdd.literal( 0 ) ) );
+    stringstream ss;
+    bdd.save( ss, { f, bdd.NOT( g ) } );
+    string const bytes = ss.str();
+
+    /* Loading into the same manager gives back the same edges. */
+    cout << "  checking reload";
+    passed &= checkEQ( bdd.load( ss ) == vector<BDD::index_t>{ f, bdd.NOT( g ) }, true );
+
+    /* A manager with another order gets the same functions. */
+    BDD other( 4 );
+    other.swap_levels( 0 );
+    other.swap_levels( 2 );
+    auto const roots = other.load( reinterpret_cast<uint8_t const*>( bytes.data() ), bytes.size() );
+    passed &= check( other.get_tt( roots[0] ), bdd.get_tt( f ) );
+    passed &= check( other.get_tt( roots[1] ), bdd.get_tt( bdd.NOT( g ) ) );
+    cout << "  checking truncated data";
+    passed &= checkEQ( other.load( reinterpret_cast<uint8_t const*>( bytes.data() ), bytes.size() - 1u ).size(), 0 );
+  }
+
+  {
+    cout << "test 21: netlist front-end" << endl;
+    /* A full adder, and its carry out as a latch, in two formats. */
+    istringstream bench( "INPUT(a)\nINPUT(b)\nOUTPUT(s)\nq = DFF(c)\nt = XOR(a, b)\ns = XOR(t, q)\n"
+                         "c = OR(u, v)\nu = AND(a, b)\nv = AND(t, q)\n" );
+    istringstream aiger( "aag 10 2 1 1 7\n2\n4\n6 21\n18\n"
+                         "8 2 4\n10 3 5\n12 9 11\n14 12 6\n16 13 7\n18 15 17\n20 9 15\n" );
+    Netlist from_bench, from_aiger;
+    string error;
+    cout << "  checking parsers";
+    passed &= checkEQ( read_bench( bench, from_bench, error ) && read_aiger( aiger, from_aiger, error ), true );
+
+    /* Both get the same BDDs on one manager, with the same inputs (a, b, then the latch). */
+    BDD bdd( 3 );
+    vector<BDD::index_t> outputs_bench, outputs_aiger;
+    Build_Stats stats;
+    build_bdds( bdd, from_bench, outputs_bench, stats, error );
+    build_bdds( bdd, from_aiger, outputs_aiger, stats, error );
+    auto const a = create_tt_nth_var( 3, 0 ), b = create_tt_nth_var( 3, 1 ), q = create_tt_nth_var( 3, 2 );
+    passed &= check( bdd.get_tt( outputs_bench[0] ), a ^ b ^ q );
+    passed &= check( bdd.get_tt( outputs_bench[1] ), ( a & b ) | ( ( a ^ b ) & q ) );
+    cout << "  checking identical BDDs";
+    passed &= checkEQ( outputs_bench == outputs_aiger, true );
+    cout << "  checking that only the outputs stay alive";
+    passed &= checkEQ( bdd.num_nodes(), 6 );
+  }
+
+  {
+    cout << "test 22: statistics" << endl;
+    BDD bdd( 8 );
+    uint32_t num_reports = 0u;
+    bdd.set_stats_callback( [&]( BDD::Stats const& ) { ++num_reports; }, 0.0 );
+    auto f = bdd.ref( bdd.constant( false ) );
+    for ( uint32_t i = 0u; i < 8u; i += 2u )
+    {
+      auto const t = bdd.ref( bdd.OR( f, bdd.AND( bdd.literal( i ), bdd.literal( i + 1u ) ) ) );
+      bdd.deref( f );
+      f = t;
+    }
+    bdd.garbage_collect();
+    auto const stats = bdd.stats();
+    auto const& ands = stats.ops[static_cast<uint32_t>( BDD::Op::AND )];
+    cout << "  checking operator counters";
+    passed &= checkEQ( ands.calls == ands.terminal_hits + ands.cache.hits + ands.cache.misses && ands.calls > 0u, true );
+    cout << "  checking node counters";
+    passed &= checkEQ( stats.living_nodes, bdd.num_nodes( f ) );
+    cout << "  checking peak and created nodes";
+    passed &= checkEQ( stats.peak_nodes >= stats.living_nodes && stats.created_nodes >= stats.peak_nodes, true );
+    cout << "  checking unique table counters";
+    uint64_t lookups = 0u;
+    for ( auto const& level : stats.levels )
+    {
+      lookups += level.lookups;
+    }
+    passed &= checkEQ( lookups >= stats.created_nodes, true );
+    cout << "  checking garbage collection counters";
+    passed &= checkEQ( stats.num_gc, 1 );
+    cout << "  checking freed nodes";
+    passed &= checkEQ( stats.gc_freed_nodes, stats.created_nodes - stats.living_nodes );
+    cout << "  checking the callback";
+    passed &= checkEQ( num_reports, 8 );
+    ostringstream json;
+    stats.write_json( json );
+    cout << "  checking JSON";
+    passed &= checkEQ( json.str().find( "\"levels\": [" ) != string::npos, true );
+  }
+
+  {
+    cout << "test 23: chunked node storage" << endl;
+    Chunked_Array<uint64_t, 4u> array;
+    for ( uint64_t i = 0u; i < 10u; ++i )
+    {
+      array.emplace_back( i );
+    }
+    uint64_t const* const fifth = &array[5];
+    array.resize( 1000u );
+    for ( uint64_t i = 10u; i < 1000u; ++i )
+    {
+      array[i] = i;
+    }
+    cout << "  checking stable addresses";
+    passed &= checkEQ( &array[5] == fifth && array[5] == 5u && array[999] == 999u, true );
+    cout << "  checking capacity";
+    passed &= checkEQ( array.capacity(), 1008 );
+
+    /* The same functions with the nodes reserved up front, on huge pages if available. */
+    BDD bdd( 10, 16, 1u << 21, Huge_Pages::TRANSPARENT );
+    auto f = bdd.ref( bdd.constant( false ) );
+    Truth_Table tt( 10 );
+    for ( uint32_t i = 0u; i < 10u; i += 2u )
+    {
+      auto const t = bdd.ref( bdd.XOR( f, bdd.AND( bdd.literal( i ), bdd.literal( i + 1u ) ) ) );
+      bdd.deref( f );
+      f = t;
+      tt = tt ^ ( create_tt_nth_var( 10, i ) & create_tt_nth_var( 10, i + 1u ) );
+    }
+    passed &= check( bdd.get_tt( f ), tt );
+  }
+
+  {
+    cout << "test 24: compaction" << endl;
+    BDD bdd( 6 );
+    auto const x = [&]( uint32_t i ) { return bdd.literal( i ); };
+    auto f = bdd.ref( bdd.XOR( bdd.AND( x( 0 ), x( 3 ) ), bdd.AND( x( 1 ), x( 4 ) ) ) );
+    auto g = bdd.ref( bdd.NOT( bdd.OR( bdd.AND( x( 2 ), x( 5 ) ), f ) ) );
+    bdd.ref( bdd.AND( x( 0 ), x( 1 ) ) ); /* living too, though its edge is not kept */
+    bdd.AND( f, x( 2 ) ); /* dead */
+    auto const tts = bdd.get_tt( { f, g } );
+    auto const size = bdd.num_nodes();
+    auto const remap = bdd.compact();
+    f = BDD::remap_edge( remap, f );
+    g = BDD::remap_edge( remap, g );
+    passed &= check( bdd.get_tt( f ), tts[0] );
+    passed &= check( bdd.get_tt( g ), tts[1] );
+    cout << "  checking BDD size (living nodes)";
+    passed &= checkEQ( bdd.num_nodes(), size );
+    cout << "  checking canonicity";
+    passed &= checkEQ( bdd.from_tt( tts[1] ), g );
+  }
+
+  {
+    cout << "test 25: index and variable widths" << endl;
+    BDD bdd( 8 );
+    Basic_BDD<uint64_t> wide( 8 );
+    Basic_BDD<uint32_t, uint16_t> narrow( 8 );
+    Basic_BDD<uint16_t, uint16_t> tiny( 8 );
+    uint64_t size, wide_size, narrow_size, tiny_size;
+    auto const tts = build_on( bdd, size );
+    auto const wide_tts = build_on( wide, wide_size );
+    auto const narrow_tts = build_on( narrow, narrow_size );
+    auto const tiny_tts = build_on( tiny, tiny_size );
+    for ( uint32_t i = 0u; i < tts.size(); ++i )
+    {
+      passed &= check( wide_tts[i], tts[i] );
+      passed &= check( narrow_tts[i], tts[i] );
+      passed &= check( tiny_tts[i], tts[i] );
+    }
+    cout << "  checking BDD sizes";
+    passed &= checkEQ( ( wide_size == size ) + ( narrow_size == size ) + ( tiny_size == size ), 3 );
+  }
+
+  {
+    cout << "test 26: all 2-input functions" << endl;
+    BDD bdd( 4 );
+    auto const x = [&]( uint32_t i ) { return bdd.literal( i ); };
+    auto const f = bdd.ref( bdd.ITE( x( 0 ), bdd.XOR( x( 1 ), x( 2 ) ), x( 3 ) ) );
+    auto const g = bdd.ref( bdd.OR( bdd.AND( x( 1 ), x( 3 ) ), bdd.AND( bdd.NOT( x( 0 ) ), x( 2 ) ) ) );
+    std::vector<std::pair<BDD::index_t, BDD::index_t>> const operands = {
+        { f, g }, { g, f }, { f, f }, { f, bdd.NOT( f ) }, { bdd.constant( true ), g }, { f, bdd.constant( false ) } };
+    uint32_t num_wrong = 0u;
+    for ( auto const& fg : operands )
+    {
+      auto const ft = bdd.get_tt( fg.first ), gt = bdd.get_tt( fg.second );
+      for ( uint32_t table = 0u; table < 16u; ++table )
+      {
+        Truth_Table expected = ft ^ ft;
+        Truth_Table const minterms[] = { ~ft & ~gt, ft & ~gt, ~ft & gt, ft & gt };
+        for ( uint32_t m = 0u; m < 4u; ++m )
+        {
+          if ( ( table >> m & 1u ) != 0u )
+          {
+            expected = expected | minterms[m];
+          }
+        }
+        num_wrong += bdd.get_tt( bdd.connective( table, fg.first, fg.second ) ) != expected;
+      }
+    }
+    cout << "  checking function correctness";
+    passed &= checkEQ( num_wrong, 0 );
+    cout << "  checking IMPLIES";
+    passed &= checkEQ( bdd.get_tt( bdd.IMPLIES( f, g ) ) == ( ~bdd.get_tt( f ) | bdd.get_tt( g ) ), true );
+    cout << "  checking that NOR shares the computed table of AND";
+    bdd.NOR( f, g );
+    auto const before = bdd.num_invoke();
+    bdd.AND( bdd.NOT( f ), bdd.NOT( g ) );
+    passed &= checkEQ( bdd.num_invoke() - before, 3 );
+  }
+
+  {
+    cout << "test 27: ITE standard triples" << endl;
+    BDD bdd( 4 );
+    auto const x = [&]( uint32_t i ) { return bdd.literal( i ); };
+    auto const f = bdd.ref( bdd.XOR( x( 0 ), bdd.AND( x( 1 ), x( 3 ) ) ) );
+    auto const g = bdd.ref( bdd.OR( x( 2 ), x( 3 ) ) );
+    auto const h = bdd.ref( bdd.ITE( f, g, x( 1 ) ) );
+    auto const or_fg = bdd.ref( bdd.OR( f, g ) );
+    auto const xor_fg = bdd.ref( bdd.XOR( f, g ) );
+    auto const before = bdd.num_invoke();
+    cout << "  checking degenerate triples";
+    passed &= checkEQ( ( bdd.ITE( f, f, g ) == or_fg ) + ( bdd.ITE( g, bdd.NOT( f ), f ) == xor_fg ), 2 );
+    cout << "  checking equivalent triples";
+    passed &= checkEQ( ( bdd.ITE( bdd.NOT( f ), x( 1 ), g ) == h ) +
+                       ( bdd.ITE( f, bdd.NOT( g ), bdd.NOT( x( 1 ) ) ) == bdd.NOT( h ) ), 2 );
+    cout << "  checking number of computation";
+    passed &= checkEQ( bdd.num_invoke() - before, 4 + 5 ); /* computed table hits and NOTs */
+  }
+
+  {
+    cout << "test 28: saturated reference counts" << endl;
+    Basic_BDD<uint32_t, uint32_t, uint8_t> bdd( 6 ); /* counts saturate at 255 */
+    auto const x = [&]( uint32_t i ) { return bdd.literal( i ); };
+    auto f = bdd.XOR( bdd.AND( x( 0 ), x( 2 ) ), bdd.OR( x( 1 ), x( 5 ) ) );
+    auto const g = bdd.ref( bdd.AND( f, x( 3 ) ) );
+    auto const tt = bdd.get_tt( f );
+    for ( uint32_t i = 0u; i < 300u; ++i )
+    {
+      bdd.ref( f );
+    }
+    for ( uint32_t i = 0u; i < 300u; ++i )
+    {
+      bdd.deref( f );
+    }
+    bdd.deref( g );
+    cout << "  checking that the saturated node stays alive";
+    passed &= checkEQ( bdd.is_dead( f ), false );
+    bdd.garbage_collect();
+    passed &= check( bdd.get_tt( f ), tt );
+    cout << "  checking BDD size (living nodes)";
+    passed &= checkEQ( bdd.num_nodes(), bdd.num_nodes( f ) );
+    auto const remap = bdd.compact();
+    f = Basic_BDD<uint32_t, uint32_t, uint8_t>::remap_edge( remap, f );
+    passed &= check( bdd.get_tt( f ), tt );
+  }
+
   if ( passed )
   {
     cout << endl << "All tests passed, congrats!" << endl;
@@ -0,0 +1,801 @@
+#pragma once
+
+#include "BDD.hpp"
+
+#include <istream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+
+/* The combinational part of a gate-level netlist, read from AIGER, BLIF or BENCH.
+ * The latches are cut: their outputs become inputs (after the primary inputs), and their next-state functions
+ * become outputs (after the primary outputs). Signals are referred to by literals, `signal << 1 | complemented`. */
+struct Netlist
+{
+  using literal_t = uint32_t;
+
+  enum class Gate_Type : uint8_t
+  {
+    INPUT,
+    CONSTANT, /* false */
+    AND, /* of the fanins */
+    OR,
+    XOR,
+    COVER /* sum of the products in `cover` */
+  };
+
+  struct Signal
+  {
+    std::string name;
+    Gate_Type type = Gate_Type::INPUT;
+    bool complemented = false; /* whether the gate output is complemented (NAND, off-set cover, ...) */
+    bool defined = false; /* whether a gate, an input or a latch drives the signal */
+    std::vector<literal_t> fanins;
+    std::vector<std::string> cover; /* for a COVER, one cube per string, with '0', '1' or '-' for each fanin */
+  };
+
+  std::vector<Signal> signals;
+  std::vector<uint32_t> inputs; /* signals; the last `num_latches` ones are latch outputs */
+  std::vector<literal_t> outputs; /* the last `num_latches` ones are latch next states */
+  std::vector<std::string> output_names;
+  uint32_t num_latches = 0u;
+};
+
+namespace netlist_detail
+{
+
+/* Look up the signal `name`, creating it (undefined) if needed. */
+inline uint32_t signal_of( Netlist& netlist, std::unordered_map<std::string, uint32_t>& by_name, std::string const& name )
+{
+  auto const it = by_name.find( name );
+  if ( it != by_name.end() )
+  {
+    return it->second;
+  }
+  uint32_t const s = netlist.signals.size();
+  netlist.signals.emplace_back();
+  netlist.signals.back().name = name;
+  by_name.emplace( name, s );
+  return s;
+}
+
+/* Mark signal `s` as driven by `type`. Return false if it already was. */
+inline bool define( Netlist& netlist, uint32_t s, Netlist::Gate_Type type, std::string& error )
+{
+  Netlist::Signal& signal = netlist.signals[s];
+  if ( signal.defined )
+  {
+    error = "signal " + signal.name + " is defined twice";
+    return false;
+  }
+  signal.type = type;
+  signal.defined = true;
+  return true;
+}
+
+/* Cut the latches given as ( output signal, next state ) pairs, after the primary inputs and outputs. */
+inline void add_latches( Netlist& netlist, std::vector<std::pair<uint32_t, Netlist::literal_t>> const& latches )
+{
+  for ( auto const& latch : latches )
+  {
+    netlist.inputs.emplace_back( latch.first );
+  }
+  for ( auto const& latch : latches )
+  {
+    netlist.outputs.emplace_back( latch.second );
+    netlist.output_names.emplace_back( netlist.signals[latch.first].name + "$next" );
+  }
+  netlist.num_latches = latches.size();
+}
+
+inline std::vector<std::string> split( std::string const& line, char separator = ' ' )
+{
+  std::vector<std::string> tokens;
+  std::string token;
+  for ( char const c : line + separator )
+  {
+    if ( c == separator || ( separator == ' ' && std::isspace( static_cast<unsigned char>( c ) ) ) )
+    {
+      if ( !token.empty() || separator != ' ' )
+      {
+        tokens.emplace_back( token );
+      }
+      token.clear();
+    }
+    else
+    {
+      token.push_back( c );
+    }
+  }
+  return tokens;
+}
+
+inline bool is_number( std::string const& token )
+{
+  return !token.empty() && token.size() < 20u && token.find_first_not_of( "0123456789" ) == std::string::npos;
+}
+
+/* Read an unsigned integer of the binary AIGER format: 7 bits per byte, the lowest first. */
+inline bool get_aiger_delta( std::istream& is, uint64_t& x )
+{
+  x = 0u;
+  for ( uint32_t shift = 0u; shift < 64u; shift += 7u )
+  {
+    int const byte = is.get();
+    if ( byte == EOF )
+    {
+      return false;
+    }
+    x |= uint64_t( byte & 0x7f ) << shift;
+    if ( ( byte & 0x80 ) == 0 )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace netlist_detail
+
+/* Read an ASCII ("aag") or binary ("aig") AIGER file. The bad state and invariant constraint properties become
+ * outputs after the primary ones; justice and fairness properties are not supported. */
+inline bool read_aiger( std::istream& is, Netlist& netlist, std::string& error )
+{
+  using namespace netlist_detail;
+  netlist = Netlist();
+
+  std::string line;
+  std::getline( is, line );
+  auto const header = split( line );
+  if ( header.size() < 6u || header.size() > 10u || ( header[0] != "aag" && header[0] != "aig" ) ||
+       !std::all_of( header.begin() + 1, header.end(), is_number ) )
+  {
+    error = "invalid AIGER header: " + line;
+    return false;
+  }
+  bool const binary = header[0] == "aig";
+  std::vector<uint64_t> counts; /* M I L O A B C J F */
+  for ( std::size_t k = 1u; k < header.size(); ++k )
+  {
+    counts.emplace_back( std::stoull( header[k] ) );
+  }
+  counts.resize( 9u, 0u );
+  uint64_t const M = counts[0], I = counts[1], L = counts[2], A = counts[4];
+  uint64_t const num_outputs = counts[3] + counts[5] + counts[6];
+  if ( counts[7] != 0u || counts[8] != 0u )
+  {
+    error = "AIGER justice and fairness properties are not supported";
+    return false;
+  }
+  if ( M >= ( 1u << 30 ) || I + L + A > M || ( binary && I + L + A != M ) )
+  {
+    error = "inconsistent AIGER header: " + line;
+    return false;
+  }
+
+  netlist.signals.resize( M + 1u );
+  for ( uint64_t v = 0u; v <= M; ++v )
+  {
+    netlist.signals[v].name = "n" + std::to_string( v );
+  }
+  netlist.signals[0].type = Netlist::Gate_Type::CONSTANT;
+  netlist.signals[0].defined = true;
+
+  /* Read a line of `count` literals (and up to `optional` more numbers). */
+  std::vector<uint64_t> numbers;
+  auto const read_literals = [&]( std::size_t count, std::size_t optional ) {
+    std::getline( is, line );
+    auto const tokens = split( line );
+    if ( !is || tokens.size() < count || tokens.size() > count + optional ||
+         !std::all_of( tokens.begin(), tokens.end(), is_number ) )
+    {
+      error = "invalid AIGER line: " + line;
+      return false;
+    }
+    numbers.clear();
+    for ( auto const& token : tokens )
+    {
+      numbers.emplace_back( std::stoull( token ) );
+    }
+    if ( std::any_of( numbers.begin(), numbers.begin() + count, [&]( uint64_t lit ) { return ( lit >> 1 ) > M; } ) )
+    {
+      error = "AIGER literal out of range: " + line;
+      return false;
+    }
+    return true;
+  };
+  /* Define the variable of `lit`, which must be even and not constant. */
+  auto const define_literal = [&]( uint64_t lit, Netlist::Gate_Type type ) {
+    if ( ( lit & 1u ) != 0u || lit < 2u )
+    {
+      error = "invalid AIGER definition of literal " + std::to_string( lit );
+      return false;
+    }
+    return define( netlist, lit >> 1, type, error );
+  };
+
+  for ( uint64_t k = 0u; k < I; ++k )
+  {
+    uint64_t lit = 2u * ( k + 1u );
+    if ( !binary )
+    {
+      if ( !read_literals( 1u, 0u ) )
+      {
+        return false;
+      }
+      lit = numbers[0];
+    }
+    if ( !define_literal( lit, Netlist::Gate_Type::INPUT ) )
+    {
+      return false;
+    }
+    netlist.inputs.emplace_back( lit >> 1 );
+    netlist.signals[lit >> 1].name = "i" + std::to_string( k );
+  }
+
+  /* A latch is `next [init]` in binary, `lit next [init]` in ASCII. */
+  std::vector<std::pair<uint32_t, Netlist::literal_t>> latches;
+  for ( uint64_t k = 0u; k < L; ++k )
+  {
+    uint64_t lit = 2u * ( I + k + 1u );
+    if ( !read_literals( binary ? 1u : 2u, 1u ) )
+    {
+      return false;
+    }
+    if ( !binary )
+    {
+      lit = numbers[0];
+      numbers.erase( numbers.begin() );
+    }
+    if ( !define_literal( lit, Netlist::Gate_Type::INPUT ) )
+    {
+      return false;
+    }
+    latches.emplace_back( lit >> 1, numbers[0] );
+    netlist.signals[lit >> 1].name = "l" + std::to_string( k );
+  }
+
+  for ( uint64_t k = 0u; k < num_outputs; ++k )
+  {
+    if ( !read_literals( 1u, 0u ) )
+    {
+      return false;
+    }
+    netlist.outputs.emplace_back( numbers[0] );
+    if ( k < counts[3] )
+    {
+      netlist.output_names.emplace_back( "o" + std::to_string( k ) );
+    }
+    else if ( k < counts[3] + counts[5] )
+    {
+      netlist.output_names.emplace_back( "b" + std::to_string( k - counts[3] ) );
+    }
+    else
+    {
+      netlist.output_names.emplace_back( "c" + std::to_string( k - counts[3] - counts[5] ) );
+    }
+  }
+
+  /* In binary, AND gate k is `2 ( I + L + k + 1 ) = rhs0 + delta0` and `rhs0 = rhs1 + delta1`. */
+  for ( uint64_t k = 0u; k < A; ++k )
+  {
+    uint64_t lhs, rhs0, rhs1;
+    if ( binary )
+    {
+      uint64_t delta0, delta1;
+      lhs = 2u * ( I + L + k + 1u );
+      if ( !get_aiger_delta( is, delta0 ) || !get_aiger_delta( is, delta1 ) || delta0 == 0u || delta0 > lhs ||
+           delta1 > lhs - delta0 )
+      {
+        error = "invalid binary AIGER AND gate " + std::to_string( k );
+        return false;
+      }
+      rhs0 = lhs - delta0;
+      rhs1 = rhs0 - delta1;
+    }
+    else
+    {
+      if ( !read_literals( 3u, 0u ) )
+      {
+        return false;
+      }
+      lhs = numbers[0];
+      rhs0 = numbers[1];
+      rhs1 = numbers[2];
+    }
+    if ( !define_literal( lhs, Netlist::Gate_Type::AND ) )
+    {
+      return false;
+    }
+    netlist.signals[lhs >> 1].fanins = { Netlist::literal_t( rhs0 ), Netlist::literal_t( rhs1 ) };
+  }
+
+  /* The optional symbol table, up to the comment section. */
+  while ( std::getline( is, line ) && !line.empty() && line != "c" )
+  {
+    std::size_t const space = line.find( ' ' );
+    std::string const index = line.substr( 1u, space == std::string::npos ? std::string::npos : space - 1u );
+    if ( space == std::string::npos || !is_number( index ) )
+    {
+      error = "invalid AIGER symbol: " + line;
+      return false;
+    }
+    uint64_t const k = std::stoull( index );
+    std::string const name = line.substr( space + 1u );
+    if ( line[0] == 'i' && k < I )
+    {
+      netlist.signals[netlist.inputs[k]].name = name;
+    }
+    else if ( line[0] == 'l' && k < L )
+    {
+      netlist.signals[latches[k].first].name = name;
+    }
+    else if ( line[0] == 'o' && k < counts[3] )
+    {
+      netlist.output_names[k] = name;
+    }
+    else if ( line[0] == 'b' && k < counts[5] )
+    {
+      netlist.output_names[counts[3] + k] = name;
+    }
+    else if ( line[0] == 'c' && k < counts[6] )
+    {
+      netlist.output_names[counts[3] + counts[5] + k] = name;
+    }
+    else
+    {
+      error = "invalid AIGER symbol: " + line;
+      return false;
+    }
+  }
+
+  add_latches( netlist, latches );
+  return true;
+}
+
+/* Read the first model of a BLIF file: `.inputs`, `.outputs`, `.names` and `.latch` (whose type, control and
+ * initial value are ignored). Hierarchical and library constructs (`.subckt`, `.gate`) are not supported;
+ * the other commands are ignored. */
+inline bool read_blif( std::istream& is, Netlist& netlist, std::string& error )
+{
+  using namespace netlist_detail;
+  netlist = Netlist();
+  std::unordered_map<std::string, uint32_t> by_name;
+  std::vector<std::pair<uint32_t, Netlist::literal_t>> latches;
+  uint32_t names = 0u; /* signal of the `.names` being read */
+  bool in_cover = false;
+
+  std::string line, logical;
+  while ( std::getline( is, line ) )
+  {
+    line = line.substr( 0u, line.find( '#' ) );
+    if ( !line.empty() && line.back() == '\r' )
+    {
+      line.pop_back();
+    }
+    if ( !line.empty() && line.back() == '\\' )
+    {
+      line.back() = ' ';
+      logical += line;
+      continue;
+    }
+    logical += line;
+    auto const tokens = split( logical );
+    logical.clear();
+    if ( tokens.empty() )
+    {
+      continue;
+    }
+
+    if ( tokens[0][0] != '.' )
+    {
+      if ( !in_cover )
+      {
+        error = "BLIF cube outside of .names: " + line;
+        return false;
+      }
+      Netlist::Signal& s = netlist.signals[names];
+      std::string const cube = s.fanins.empty() ? "" : tokens[0];
+      std::string const value = tokens.back();
+      bool const valid_cube = cube.size() == s.fanins.size() && cube.find_first_not_of( "01-" ) == std::string::npos;
+      if ( tokens.size() != ( s.fanins.empty() ? 1u : 2u ) || !valid_cube || ( value != "0" && value != "1" ) ||
+           ( !s.cover.empty() && s.complemented != ( value == "0" ) ) )
+      {
+        error = "invalid BLIF cube for " + s.name + ": " + line;
+        return false;
+      }
+      s.complemented = value == "0";
+      s.cover.emplace_back( cube );
+      continue;
+    }
+
+    in_cover = false;
+    std::string const& command = tokens[0];
+    if ( command == ".model" )
+    {
+      continue;
+    }
+    else if ( command == ".inputs" )
+    {
+      for ( std::size_t k = 1u; k < tokens.size(); ++k )
+      {
+        uint32_t const s = signal_of( netlist, by_name, tokens[k] );
+        if ( !define( netlist, s, Netlist::Gate_Type::INPUT, error ) )
+        {
+          return false;
+        }
+        netlist.inputs.emplace_back( s );
+      }
+    }
+    else if ( command == ".outputs" )
+    {
+      for ( std::size_t k = 1u; k < tokens.size(); ++k )
+      {
+        netlist.outputs.emplace_back( signal_of( netlist, by_name, tokens[k] ) << 1 );
+        netlist.output_names.emplace_back( tokens[k] );
+      }
+    }
+    else if ( command == ".names" )
+    {
+      if ( tokens.size() < 2u )
+      {
+        error = "invalid BLIF .names: " + line;
+        return false;
+      }
+      names = signal_of( netlist, by_name, tokens.back() );
+      if ( !define( netlist, names, Netlist::Gate_Type::COVER, error ) )
+      {
+        return false;
+      }
+      for ( std::size_t k = 1u; k + 1u < tokens.size(); ++k )
+      {
+        uint32_t const fanin = signal_of( netlist, by_name, tokens[k] );
+        netlist.signals[names].fanins.emplace_back( fanin << 1 );
+      }
+      in_cover = true;
+    }
+    else if ( command == ".latch" )
+    {
+      if ( tokens.size() < 3u || tokens.size() > 6u )
+      {
+        error = "invalid BLIF .latch: " + line;
+        return false;
+      }
+      uint32_t const next = signal_of( netlist, by_name, tokens[1] );
+      uint32_t const s = signal_of( netlist, by_name, tokens[2] );
+      if ( !define( netlist, s, Netlist::Gate_Type::INPUT, error ) )
+      {
+        return false;
+      }
+      latches.emplace_back( s, next << 1 );
+    }
+    else if ( command == ".end" || command == ".exdc" )
+    {
+      break;
+    }
+    else if ( command == ".subckt" || command == ".gate" || command == ".mlatch" || command == ".search" )
+    {
+      error = "unsupported BLIF construct " + command;
+      return false;
+    }
+    /* The other commands (timing, clocks, ...) do not change the logic. */
+  }
+
+  add_latches( netlist, latches );
+  return true;
+}
+
+/* Read a BENCH file (ISCAS style): `INPUT(a)`, `OUTPUT(b)` and `c = TYPE(a, b, ...)` with the types AND, NAND, OR,
+ * NOR, XOR, XNOR, NOT, BUF (or BUFF) and DFF, in any case. */
+inline bool read_bench( std::istream& is, Netlist& netlist, std::string& error )
+{
+  using namespace netlist_detail;
+  netlist = Netlist();
+  std::unordered_map<std::string, uint32_t> by_name;
+  std::vector<std::pair<uint32_t, Netlist::literal_t>> latches;
+
+  std::string line;
+  while ( std::getline( is, line ) )
+  {
+    std::string statement;
+    for ( char const c : line.substr( 0u, line.find( '#' ) ) )
+    {
+      if ( !std::isspace( static_cast<unsigned char>( c ) ) )
+      {
+        statement.push_back( c );
+      }
+    }
+    if ( statement.empty() )
+    {
+      continue;
+    }
+
+    /* `lhs = type(args)`, or `type(args)` for the inputs and outputs */
+    std::size_t const equal = statement.find( '=' );
+    std::size_t const open = statement.find( '(', equal == std::string::npos ? 0u : equal );
+    if ( open == std::string::npos || statement.back() != ')' )
+    {
+      error = "invalid BENCH line: " + line;
+      return false;
+    }
+    std::size_t const type_begin = equal == std::string::npos ? 0u : equal + 1u;
+    std::string type = statement.substr( type_begin, open - type_begin );
+    std::transform( type.begin(), type.end(), type.begin(), []( char c ) { return char( std::toupper( c ) ); } );
+    auto const args = split( statement.substr( open + 1u, statement.size() - open - 2u ), ',' );
+    if ( std::any_of( args.begin(), args.end(), []( std::string const& a ) { return a.empty(); } ) )
+    {
+      error = "invalid BENCH line: " + line;
+      return false;
+    }
+
+    if ( equal == std::string::npos )
+    {
+      if ( args.size() != 1u || ( type != "INPUT" && type != "OUTPUT" ) )
+      {
+        error = "invalid BENCH line: " + line;
+        return false;
+      }
+      uint32_t const s = signal_of( netlist, by_name, args[0] );
+      if ( type == "INPUT" )
+      {
+        if ( !define( netlist, s, Netlist::Gate_Type::INPUT, error ) )
+        {
+          return false;
+        }
+        netlist.inputs.emplace_back( s );
+      }
+      else
+      {
+        netlist.outputs.emplace_back( s << 1 );
+        netlist.output_names.emplace_back( args[0] );
+      }
+      continue;
+    }
+
+    uint32_t const s = signal_of( netlist, by_name, statement.substr( 0u, equal ) );
+    std::vector<Netlist::literal_t> fanins;
+    for ( auto const& arg : args )
+    {
+      fanins.emplace_back( signal_of( netlist, by_name, arg ) << 1 );
+    }
+    bool const single = fanins.size() == 1u;
+    Netlist::Gate_Type gate_type;
+    bool complemented = false;
+    if ( type == "AND" || type == "NAND" )
+    {
+      gate_type = Netlist::Gate_Type::AND;
+      complemented = type == "NAND";
+    }
+    else if ( type == "OR" || type == "NOR" )
+    {
+      gate_type = Netlist::Gate_Type::OR;
+      complemented = type == "NOR";
+    }
+    else if ( type == "XOR" || type == "XNOR" )
+    {
+      gate_type = Netlist::Gate_Type::XOR;
+      complemented = type == "XNOR";
+    }
+    else if ( ( type == "NOT" || type == "BUF" || type == "BUFF" ) && single )
+    {
+      gate_type = Netlist::Gate_Type::AND;
+      complemented = type == "NOT";
+    }
+    else if ( type == "DFF" && single )
+    {
+      if ( !define( netlist, s, Netlist::Gate_Type::INPUT, error ) )
+      {
+        return false;
+      }
+      latches.emplace_back( s, fanins[0] );
+      continue;
+    }
+    else
+    {
+      error = "unsupported BENCH gate: " + line;
+      return false;
+    }
+    if ( !define( netlist, s, gate_type, error ) )
+    {
+      return false;
+    }
+    netlist.signals[s].complemented = complemented;
+    netlist.signals[s].fanins = fanins;
+  }
+
+  add_latches( netlist, latches );
+  return true;
+}
+
+/* Read the netlist in the file `path`: AIGER (recognized by its header), or else BLIF or BENCH by the extension. */
+inline bool read_netlist( std::string const& path, Netlist& netlist, std::string& error )
+{
+  std::ifstream is( path, std::ios::binary );
+  if ( !is )
+  {
+    error = "cannot open " + path;
+    return false;
+  }
+  char magic[3] = { 0, 0, 0 };
+  is.read( magic, 3 );
+  is.clear();
+  is.seekg( 0 );
+  std::string const extension = path.substr( std::min( path.size(), path.rfind( '.' ) ) );
+  if ( std::string( magic, 3u ) == "aag" || std::string( magic, 3u ) == "aig" )
+  {
+    return read_aiger( is, netlist, error );
+  }
+  else if ( extension == ".blif" )
+  {
+    return read_blif( is, netlist, error );
+  }
+  else if ( extension == ".bench" )
+  {
+    return read_bench( is, netlist, error );
+  }
+  error = "unknown netlist format of " + path + " (expected AIGER, .blif or .bench)";
+  return false;
+}
+
+/* Statistics of `build_bdds`. */
+struct Build_Stats
+{
+  double seconds = 0.0;
+  uint64_t num_gates = 0u; /* gates in the transitive fanin of the outputs, the only ones built */
+  uint64_t peak_live_nodes = 0u; /* most living nodes in the manager at any point */
+};
+
+/* Build the BDDs of the outputs of `netlist` on `bdd`, with input k as variable k. The gates are built in
+ * topological order, and the BDD of a gate is released as soon as its last fanout has been built, which keeps only
+ * the frontier of the netlist alive. Fill `outputs` with the (referenced) BDDs of the outputs, or return false with
+ * `error` set if an output depends on an undefined signal or on a combinational cycle. */
+inline bool build_bdds( BDD& bdd, Netlist const& netlist, std::vector<BDD::index_t>& outputs, Build_Stats& stats,
+                        std::string& error )
+{
+  using index_t = BDD::index_t;
+  using Gate_Type = Netlist::Gate_Type;
+  auto const start = std::chrono::steady_clock::now();
+  assert( netlist.inputs.size() <= bdd.num_vars() );
+  stats = Build_Stats();
+
+  /* Sort the transitive fanin of the outputs topologically, with an explicit DFS. */
+  enum : uint8_t { unvisited, on_stack, done };
+  std::vector<uint8_t> state( netlist.signals.size(), unvisited );
+  std::vector<uint32_t> order, stack;
+  for ( Netlist::literal_t const output : netlist.outputs )
+  {
+    stack.emplace_back( output >> 1 );
+    while ( !stack.empty() )
+    {
+      uint32_t const s = stack.back();
+      Netlist::Signal const& signal = netlist.signals[s];
+      if ( state[s] == unvisited )
+      {
+        if ( !signal.defined )
+        {
+          error = "signal " + signal.name + " is used but never defined";
+          return false;
+        }
+        state[s] = on_stack;
+        for ( Netlist::literal_t const fanin : signal.fanins )
+        {
+          if ( state[fanin >> 1] == on_stack )
+          {
+            error = "combinational cycle through " + netlist.signals[fanin >> 1].name;
+            return false;
+          }
+          if ( state[fanin >> 1] == unvisited )
+          {
+            stack.emplace_back( fanin >> 1 );
+          }
+        }
+      }
+      else
+      {
+        if ( state[s] == on_stack )
+        {
+          state[s] = done;
+          order.emplace_back( s );
+        }
+        stack.pop_back();
+      }
+    }
+  }
+
+  /* The number of fanouts (and outputs) that still need each signal. */
+  std::vector<uint32_t> remaining( netlist.signals.size(), 0u );
+  for ( uint32_t const s : order )
+  {
+    for ( Netlist::literal_t const fanin : netlist.signals[s].fanins )
+    {
+      ++remaining[fanin >> 1];
+    }
+  }
+  for ( Netlist::literal_t const output : netlist.outputs )
+  {
+    ++remaining[output >> 1];
+  }
+
+  std::vector<uint32_t> var_of( netlist.signals.size(), 0u );
+  for ( uint32_t k = 0u; k < netlist.inputs.size(); ++k )
+  {
+    var_of[netlist.inputs[k]] = k;
+  }
+  std::vector<index_t> edge( netlist.signals.size(), bdd.constant( false ) ); /* referenced while needed */
+  auto const edge_of = [&]( Netlist::literal_t lit ) { return edge[lit >> 1] ^ index_t( lit & 1u ); };
+  auto const release = [&]( uint32_t s ) {
+    if ( --remaining[s] == 0u )
+    {
+      bdd.deref( edge[s] );
+    }
+  };
+  /* Replace the referenced `r` with `op( r, g )`. */
+  auto const accumulate = [&]( index_t& r, index_t g, Gate_Type type ) {
+    index_t const t =
+        bdd.ref( type == Gate_Type::AND ? bdd.AND( r, g ) : type == Gate_Type::OR ? bdd.OR( r, g ) : bdd.XOR( r, g ) );
+    bdd.deref( r );
+    r = t;
+  };
+
+  for ( uint32_t const s : order )
+  {
+    Netlist::Signal const& signal = netlist.signals[s];
+    index_t r;
+    switch ( signal.type )
+    {
+    case Gate_Type::INPUT:
+      r = bdd.ref( bdd.literal( var_of[s] ) );
+      break;
+    case Gate_Type::CONSTANT:
+      r = bdd.constant( false );
+      break;
+    case Gate_Type::AND:
+    case Gate_Type::OR:
+    case Gate_Type::XOR:
+      r = bdd.ref( bdd.constant( signal.type == Gate_Type::AND ) );
+      for ( Netlist::literal_t const fanin : signal.fanins )
+      {
+        accumulate( r, edge_of( fanin ), signal.type );
+      }
+      break;
+    default:
+      r = bdd.ref( bdd.constant( false ) );
+      for ( std::string const& cube : signal.cover )
+      {
+        index_t product = bdd.ref( bdd.constant( true ) );
+        for ( std::size_t k = 0u; k < cube.size(); ++k )
+        {
+          if ( cube[k] != '-' )
+          {
+            accumulate( product, edge_of( signal.fanins[k] ) ^ index_t( cube[k] == '0' ), Gate_Type::AND );
+          }
+        }
+        accumulate( r, product, Gate_Type::OR );
+        bdd.deref( product );
+      }
+      break;
+    }
+    edge[s] = r ^ index_t( signal.complemented );
+    stats.peak_live_nodes = std::max( stats.peak_live_nodes, bdd.num_nodes() );
+    stats.num_gates += signal.type != Gate_Type::INPUT && signal.type != Gate_Type::CONSTANT;
+
+    for ( Netlist::literal_t const fanin : signal.fanins )
+    {
+      release( fanin >> 1 );
+    }
+  }
+
+  outputs.clear();
+  for ( Netlist::literal_t const output : netlist.outputs )
+  {
+    outputs.emplace_back( bdd.ref( edge_of( output ) ) );
+    release( output >> 1 );
+  }
+  stats.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+  return true;
+}
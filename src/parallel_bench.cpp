@@ -0,0 +1,124 @@
+#include "BDD.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <cstdlib>
+
+using namespace std;
+
+/* A benchmark builds its operands sequentially and returns the (timed) parallel part. */
+using Benchmark = function<BDD::index_t( BDD& bdd, function<void()> const& start_timer )>;
+
+/* The N-queens constraints, conjoined row by row and then cell by cell (many medium-sized operations). */
+BDD::index_t queens( BDD& bdd, uint32_t n, function<void()> const& start_timer )
+{
+  start_timer();
+  auto const x = [&]( uint32_t i, uint32_t j ) { return bdd.literal( i * n + j ); };
+  auto f = bdd.ref( bdd.constant( true ) );
+  for ( auto i = 0u; i < n; ++i )
+  {
+    auto row = bdd.ref( bdd.constant( false ) );
+    for ( auto j = 0u; j < n; ++j )
+    {
+      auto const t = bdd.ref( bdd.OR( row, x( i, j ) ) );
+      bdd.deref( row );
+      row = t;
+    }
+    auto const t = bdd.ref( bdd.AND( f, row ) );
+    bdd.deref( f ); bdd.deref( row );
+    f = t;
+  }
+  for ( auto i = 0u; i < n; ++i )
+  {
+    for ( auto j = 0u; j < n; ++j )
+    {
+      auto c = bdd.ref( bdd.constant( true ) );
+      for ( auto k = 0u; k < n; ++k )
+      {
+        for ( auto l = 0u; l < n; ++l )
+        {
+          bool const same = k == i && l == j;
+          if ( !same && ( k == i || l == j || k + j == i + l || k + l == i + j ) )
+          {
+            auto const t = bdd.ref( bdd.AND( c, bdd.NOT( x( k, l ) ) ) );
+            bdd.deref( c );
+            c = t;
+          }
+        }
+      }
+      auto const imp = bdd.ref( bdd.OR( bdd.NOT( x( i, j ) ), c ) );
+      bdd.deref( c );
+      auto const t = bdd.ref( bdd.AND( f, imp ) );
+      bdd.deref( f ); bdd.deref( imp );
+      f = t;
+    }
+  }
+  return f;
+}
+
+/* One AND of two large BDDs: sum_i x_i x_{i+n} and sum_i x_i x_{2n-1-i} under the order x_0 < ... < x_{2n-1}. */
+BDD::index_t large_and( BDD& bdd, uint32_t n, function<void()> const& start_timer )
+{
+  auto f = bdd.ref( bdd.constant( false ) );
+  auto g = bdd.ref( bdd.constant( false ) );
+  for ( auto i = 0u; i < n; ++i )
+  {
+    auto const a = bdd.ref( bdd.AND( bdd.literal( i ), bdd.literal( i + n ) ) );
+    auto const b = bdd.ref( bdd.AND( bdd.literal( i ), bdd.literal( 2 * n - 1 - i ) ) );
+    auto const f2 = bdd.ref( bdd.OR( f, a ) );
+    auto const g2 = bdd.ref( bdd.OR( g, b ) );
+    bdd.deref( f ); bdd.deref( g ); bdd.deref( a ); bdd.deref( b );
+    f = f2;
+    g = g2;
+  }
+  start_timer();
+  return bdd.ref( bdd.AND( f, g ) );
+}
+
+int main( int argc, char** argv )
+{
+  uint32_t const max_threads = argc > 1 ? atoi( argv[1] ) : max( 4u, thread::hardware_concurrency() );
+  uint32_t const queens_n = argc > 2 ? atoi( argv[2] ) : 9u;
+  uint32_t const and_n = argc > 3 ? atoi( argv[3] ) : 17u;
+
+  cout << "hardware threads: " << thread::hardware_concurrency() << endl;
+  vector<pair<string, pair<uint32_t, Benchmark>>> const benchmarks = {
+      { to_string( queens_n ) + "-queens", { queens_n * queens_n, [&]( BDD& bdd, function<void()> const& start ) { return queens( bdd, queens_n, start ); } } },
+      { "large AND (n = " + to_string( and_n ) + ")", { 2 * and_n, [&]( BDD& bdd, function<void()> const& start ) { return large_and( bdd, and_n, start ); } } } };
+
+  bool identical = true;
+  for ( auto const& benchmark : benchmarks )
+  {
+    cout << benchmark.first << endl;
+    double sequential_seconds = 0.0;
+    for ( uint32_t threads = 1u; threads <= max_threads; threads *= 2u )
+    {
+      BDD bdd( benchmark.second.first, 20u );
+      chrono::steady_clock::time_point start;
+      auto const start_timer = [&]() {
+        bdd.set_num_threads( threads );
+        start = chrono::steady_clock::now();
+      };
+      auto const f = benchmark.second.second( bdd, start_timer );
+      double const seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+      if ( threads == 1u )
+      {
+        sequential_seconds = seconds;
+      }
+
+      /* Recompute sequentially: canonicity gives back the same edge. */
+      bdd.set_num_threads( 1u );
+      bdd.clear_cache();
+      auto const g = benchmark.second.second( bdd, []() {} );
+      identical &= f == g;
+
+      cout << "  " << setw( 3 ) << threads << " threads: " << fixed << setprecision( 3 ) << seconds << " s, speedup "
+           << setprecision( 2 ) << sequential_seconds / seconds << ", " << bdd.num_nodes( f ) << " nodes"
+           << ( f == g ? "" : " (DIFFERENT from sequential)" ) << endl;
+    }
+  }
+  return identical ? 0 : 1;
+}
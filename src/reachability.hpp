@@ -0,0 +1,315 @@
+#pragma once
+
+#include "BDD.hpp"
+
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <cassert>
+
+/* Symbolic reachability over a transition relation given as a list of partitions, typically one per latch:
+ * T_j( x, i, x' ) over the current state variables x, the input variables i and the next state variables x'.
+ * The partitions are conjoined into clusters of bounded size, but never into a monolithic relation. An image
+ * conjoins the clusters one at a time with `and_exists`, quantifying each variable as soon as no remaining cluster
+ * depends on it; the clusters are ordered to make that happen early.
+ * The renaming between x and x' is a `permute` of the BDD, which is linear in its size when the orders of x and x'
+ * agree. */
+class Reachability
+{
+public:
+  using index_t = BDD::index_t;
+  using var_t = BDD::var_t;
+
+  /* Statistics of one iteration of a fixpoint. */
+  struct Iteration_Stats
+  {
+    double seconds = 0.0; /* time spent */
+    uint64_t peak_live_nodes = 0u; /* most living nodes in the manager between two image steps */
+    uint64_t frontier_nodes = 0u; /* size of the new states */
+    uint64_t reached_nodes = 0u; /* size of all the states reached so far */
+  };
+
+  /* Statistics of the last fixpoint. */
+  struct Fixpoint_Stats
+  {
+    std::vector<Iteration_Stats> iterations;
+    double seconds = 0.0;
+    uint64_t peak_live_nodes = 0u;
+  };
+
+  /* `current_vars[k]` and `next_vars[k]` are the current and next state variables of the same state bit.
+   * The partitions are conjoined in clusters of up to `cluster_size` nodes. */
+  Reachability( BDD& bdd, std::vector<index_t> const& partitions, std::vector<var_t> const& current_vars,
+                std::vector<var_t> const& next_vars, std::vector<var_t> const& input_vars = {},
+                uint64_t cluster_size = 1u << 12 )
+    : bdd( bdd ), current_vars( current_vars ), next_vars( next_vars ), exchange( bdd.num_vars() )
+  {
+    assert( current_vars.size() == next_vars.size() );
+    std::vector<bool> image_vars( bdd.num_vars(), false ), preimage_vars( bdd.num_vars(), false );
+    std::iota( exchange.begin(), exchange.end(), 0u );
+    for ( std::size_t k = 0u; k < current_vars.size(); ++k )
+    {
+      image_vars[current_vars[k]] = preimage_vars[next_vars[k]] = true;
+      exchange[current_vars[k]] = next_vars[k];
+      exchange[next_vars[k]] = current_vars[k];
+    }
+    for ( var_t const v : input_vars )
+    {
+      image_vars[v] = preimage_vars[v] = true;
+    }
+
+    /* Cluster the partitions in the order that is best for the images. */
+    for ( index_t const f : partitions )
+    {
+      bdd.ref( f );
+    }
+    for ( std::size_t const j : schedule( partitions, image_vars ) )
+    {
+      index_t const f = partitions[j];
+      if ( clusters.empty() || bdd.num_nodes( clusters.back() ) + bdd.num_nodes( f ) > cluster_size )
+      {
+        clusters.emplace_back( bdd.ref( f ) );
+      }
+      else
+      {
+        index_t const c = bdd.ref( bdd.AND( clusters.back(), f ) );
+        if ( bdd.num_nodes( c ) > cluster_size )
+        {
+          bdd.deref( c );
+          clusters.emplace_back( bdd.ref( f ) );
+        }
+        else
+        {
+          bdd.deref( clusters.back() );
+          clusters.back() = c;
+        }
+      }
+      bdd.deref( f );
+    }
+
+    image_plan = plan( image_vars );
+    preimage_plan = plan( preimage_vars );
+  }
+
+  ~Reachability()
+  {
+    for ( index_t const c : clusters )
+    {
+      bdd.deref( c );
+    }
+    for ( Plan const* p : { &image_plan, &preimage_plan } )
+    {
+      for ( index_t const q : p->cubes )
+      {
+        bdd.deref( q );
+      }
+    }
+  }
+
+  Reachability( Reachability const& ) = delete;
+  Reachability& operator=( Reachability const& ) = delete;
+
+  /* Get the number of clusters the partitions were conjoined into. */
+  std::size_t num_clusters() const
+  {
+    return clusters.size();
+  }
+
+  /* Compute the successors of `states` (a function of the current state variables),
+   * as a function of the current state variables. Like the operations of `BDD`, the result is not referenced. */
+  index_t image( index_t states )
+  {
+    index_t r = bdd.ref( relational_product( states, image_plan ) );
+    index_t const renamed = bdd.permute( r, exchange );
+    bdd.deref( r );
+    note_live_nodes();
+    return renamed;
+  }
+
+  /* Compute the predecessors of `states` (a function of the current state variables). */
+  index_t preimage( index_t states )
+  {
+    index_t const renamed = bdd.ref( bdd.permute( states, exchange ) );
+    note_live_nodes();
+    index_t const r = relational_product( renamed, preimage_plan );
+    bdd.deref( renamed );
+    return r;
+  }
+
+  /* Compute the states reachable from `init` (breadth-first, with the new states as the frontier). */
+  index_t forward_reachable( index_t init )
+  {
+    return fixpoint( init, true );
+  }
+
+  /* Compute the states from which `target` is reachable. */
+  index_t backward_reachable( index_t target )
+  {
+    return fixpoint( target, false );
+  }
+
+  /* Get the statistics of the last `forward_reachable` or `backward_reachable`. */
+  Fixpoint_Stats const& last_stats() const
+  {
+    return stats;
+  }
+
+private:
+  /* The clusters in the order of an image or preimage, with the variables to quantify after each of them. */
+  struct Plan
+  {
+    std::vector<std::size_t> order; /* indices in `clusters` */
+    std::vector<index_t> cubes; /* variables quantified with each cluster */
+  };
+
+  /* Replace the referenced edge `f` with `g`. */
+  void update( index_t& f, index_t g )
+  {
+    bdd.ref( g );
+    bdd.deref( f );
+    f = g;
+  }
+
+  void note_live_nodes()
+  {
+    iteration_peak = std::max( iteration_peak, bdd.num_nodes() );
+  }
+
+  /* Order `fs` greedily: next comes the function after which the most variables of `quantified` can be quantified,
+   * as no other remaining function depends on them, and then the one with the smallest support.
+   * Return the indices of the functions in this order. */
+  std::vector<std::size_t> schedule( std::vector<index_t> const& fs, std::vector<bool> const& quantified ) const
+  {
+    std::vector<std::size_t> order( fs.size() );
+    std::iota( order.begin(), order.end(), 0u );
+    std::vector<std::vector<bool>> supports;
+    for ( index_t const f : fs )
+    {
+      supports.emplace_back( bdd.support( f ) );
+    }
+    std::vector<uint32_t> occurrences( bdd.num_vars(), 0u );
+    for ( auto const& s : supports )
+    {
+      for ( var_t v = 0u; v < bdd.num_vars(); ++v )
+      {
+        occurrences[v] += s[v];
+      }
+    }
+
+    for ( std::size_t first = 0u; first < fs.size(); ++first )
+    {
+      std::size_t best = first;
+      uint32_t best_private = 0u, best_size = 0u;
+      for ( std::size_t j = first; j < fs.size(); ++j )
+      {
+        uint32_t num_private = 0u, size = 0u;
+        for ( var_t v = 0u; v < bdd.num_vars(); ++v )
+        {
+          size += supports[j][v];
+          num_private += supports[j][v] && quantified[v] && occurrences[v] == 1u;
+        }
+        if ( j == first || num_private > best_private || ( num_private == best_private && size < best_size ) )
+        {
+          best = j;
+          best_private = num_private;
+          best_size = size;
+        }
+      }
+      std::swap( order[first], order[best] );
+      std::swap( supports[first], supports[best] );
+      for ( var_t v = 0u; v < bdd.num_vars(); ++v )
+      {
+        occurrences[v] -= supports[first][v];
+      }
+    }
+    return order;
+  }
+
+  /* Order the clusters for the quantification of `quantified`, and quantify each variable with the last cluster
+   * depending on it (with the first one if none does). */
+  Plan plan( std::vector<bool> const& quantified )
+  {
+    Plan p;
+    p.order = schedule( clusters, quantified );
+    std::vector<std::size_t> last( bdd.num_vars(), 0u );
+    for ( std::size_t j = 0u; j < p.order.size(); ++j )
+    {
+      auto const s = bdd.support( clusters[p.order[j]] );
+      for ( var_t v = 0u; v < bdd.num_vars(); ++v )
+      {
+        if ( s[v] )
+        {
+          last[v] = j;
+        }
+      }
+    }
+    for ( std::size_t j = 0u; j < std::max<std::size_t>( p.order.size(), 1u ); ++j )
+    {
+      std::vector<bool> vars( bdd.num_vars(), false );
+      for ( var_t v = 0u; v < bdd.num_vars(); ++v )
+      {
+        vars[v] = quantified[v] && last[v] == j;
+      }
+      p.cubes.emplace_back( bdd.ref( bdd.cube( vars ) ) );
+    }
+    return p;
+  }
+
+  /* Conjoin `states` with the clusters in the order of `p`, quantifying as planned. */
+  index_t relational_product( index_t states, Plan const& p )
+  {
+    if ( p.order.empty() )
+    {
+      return bdd.exists( states, p.cubes[0] );
+    }
+    index_t r = bdd.ref( states );
+    for ( std::size_t j = 0u; j < p.order.size(); ++j )
+    {
+      update( r, bdd.and_exists( r, clusters[p.order[j]], p.cubes[j] ) );
+      note_live_nodes();
+    }
+    bdd.deref( r );
+    return r;
+  }
+
+  index_t fixpoint( index_t from, bool forward )
+  {
+    auto const start = std::chrono::steady_clock::now();
+    stats = Fixpoint_Stats();
+    index_t reached = bdd.ref( from ), frontier = bdd.ref( from );
+    while ( frontier != bdd.constant( false ) )
+    {
+      auto const iteration_start = std::chrono::steady_clock::now();
+      iteration_peak = bdd.num_nodes();
+      index_t const next = bdd.ref( forward ? image( frontier ) : preimage( frontier ) );
+      update( frontier, bdd.DIFF( next, reached ) );
+      bdd.deref( next );
+      update( reached, bdd.OR( reached, frontier ) );
+      note_live_nodes();
+
+      Iteration_Stats iteration;
+      iteration.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - iteration_start ).count();
+      iteration.peak_live_nodes = iteration_peak;
+      iteration.frontier_nodes = bdd.num_nodes( frontier );
+      iteration.reached_nodes = bdd.num_nodes( reached );
+      stats.iterations.emplace_back( iteration );
+      stats.peak_live_nodes = std::max( stats.peak_live_nodes, iteration_peak );
+    }
+    bdd.deref( frontier );
+    bdd.deref( reached );
+    stats.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    return reached;
+  }
+
+private:
+  BDD& bdd;
+  std::vector<var_t> current_vars;
+  std::vector<var_t> next_vars;
+  std::vector<index_t> clusters; /* referenced */
+  std::vector<var_t> exchange; /* the permutation swapping x and x' */
+  Plan image_plan, preimage_plan;
+
+  uint64_t iteration_peak = 0u;
+  Fixpoint_Stats stats;
+};
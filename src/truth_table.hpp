@@ -2,7 +2,16 @@
 
 #include <iostream>
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 #include <string>
+#include <vector>
+
+#if defined( __AVX512F__ ) || defined( __AVX2__ ) || defined( __BMI2__ )
+#include <immintrin.h>
+#endif
 
 /* masks used to filter out unused bits */
 static const uint64_t length_mask[] = {
@@ -32,38 +41,303 @@ static const uint64_t var_mask_neg[] = {
   0x0000ffff0000ffff,
   0x00000000ffffffff};
 
-/* return i if n == 2^i and i <= 6, 0 otherwise */
-inline uint8_t power_two( const uint32_t n )
+/* return i if n == 2^i and i >= 1, 0 otherwise */
+inline uint8_t power_two( const uint64_t n )
+{
+  if ( n < 2u || ( n & ( n - 1u ) ) != 0u )
+  {
+    return 0u;
+  }
+  uint8_t i = 0u;
+  while ( ( uint64_t( 1 ) << i ) != n )
+  {
+    ++i;
+  }
+  return i;
+}
+
+/* number of 64-bit words needed to store a truth table of `num_var` variables */
+inline uint64_t num_words( uint8_t const num_var )
+{
+  return num_var <= 6u ? 1u : uint64_t( 1 ) << ( num_var - 6u );
+}
+
+/* Allocator returning memory aligned to `Alignment` bytes (a cache line by default),
+ * so that the SIMD kernels below can use aligned loads and stores. */
+template<typename T, std::size_t Alignment = 64u>
+struct Aligned_Allocator
+{
+  using value_type = T;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = Aligned_Allocator<U, Alignment>;
+  };
+
+  Aligned_Allocator() = default;
+
+  template<typename U>
+  Aligned_Allocator( Aligned_Allocator<U, Alignment> const& ) {}
+
+  T* allocate( std::size_t n )
+  {
+    /* Over-allocate, and keep the pointer to free just before the aligned block. */
+    void* const raw = ::operator new( n * sizeof( T ) + Alignment + sizeof( void* ) );
+    uintptr_t const aligned = ( reinterpret_cast<uintptr_t>( raw ) + sizeof( void* ) + Alignment - 1u ) & ~uintptr_t( Alignment - 1u );
+    reinterpret_cast<void**>( aligned )[-1] = raw;
+    return reinterpret_cast<T*>( aligned );
+  }
+
+  void deallocate( T* p, std::size_t )
+  {
+    ::operator delete( reinterpret_cast<void**>( p )[-1] );
+  }
+};
+
+template<typename T, typename U, std::size_t Alignment>
+inline bool operator==( Aligned_Allocator<T, Alignment> const&, Aligned_Allocator<U, Alignment> const& )
+{
+  return true;
+}
+
+template<typename T, typename U, std::size_t Alignment>
+inline bool operator!=( Aligned_Allocator<T, Alignment> const&, Aligned_Allocator<U, Alignment> const& )
+{
+  return false;
+}
+
+/* Bulk kernels over word arrays. The widest instruction set enabled at compile time
+ * (e.g. with `-mavx2` or `-march=native`) is used, with a scalar loop for the rest. */
+namespace tt_kernels
+{
+
+/* r[i] = a[i] & b[i] */
+inline void bitwise_and( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+{
+  uint64_t i = 0u;
+#if defined( __AVX512F__ )
+  for ( ; i + 8u <= n; i += 8u )
+  {
+    _mm512_store_si512( r + i, _mm512_and_si512( _mm512_load_si512( a + i ), _mm512_load_si512( b + i ) ) );
+  }
+#elif defined( __AVX2__ )
+  for ( ; i + 4u <= n; i += 4u )
+  {
+    __m256i const x = _mm256_load_si256( reinterpret_cast<__m256i const*>( a + i ) );
+    __m256i const y = _mm256_load_si256( reinterpret_cast<__m256i const*>( b + i ) );
+    _mm256_store_si256( reinterpret_cast<__m256i*>( r + i ), _mm256_and_si256( x, y ) );
+  }
+#endif
+  for ( ; i < n; ++i )
+  {
+    r[i] = a[i] & b[i];
+  }
+}
+
+/* r[i] = a[i] | b[i] */
+inline void bitwise_or( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+{
+  uint64_t i = 0u;
+#if defined( __AVX512F__ )
+  for ( ; i + 8u <= n; i += 8u )
+  {
+    _mm512_store_si512( r + i, _mm512_or_si512( _mm512_load_si512( a + i ), _mm512_load_si512( b + i ) ) );
+  }
+#elif defined( __AVX2__ )
+  for ( ; i + 4u <= n; i += 4u )
+  {
+    __m256i const x = _mm256_load_si256( reinterpret_cast<__m256i const*>( a + i ) );
+    __m256i const y = _mm256_load_si256( reinterpret_cast<__m256i const*>( b + i ) );
+    _mm256_store_si256( reinterpret_cast<__m256i*>( r + i ), _mm256_or_si256( x, y ) );
+  }
+#endif
+  for ( ; i < n; ++i )
+  {
+    r[i] = a[i] | b[i];
+  }
+}
+
+/* r[i] = a[i] ^ b[i] */
+inline void bitwise_xor( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+{
+  uint64_t i = 0u;
+#if defined( __AVX512F__ )
+  for ( ; i + 8u <= n; i += 8u )
+  {
+    _mm512_store_si512( r + i, _mm512_xor_si512( _mm512_load_si512( a + i ), _mm512_load_si512( b + i ) ) );
+  }
+#elif defined( __AVX2__ )
+  for ( ; i + 4u <= n; i += 4u )
+  {
+    __m256i const x = _mm256_load_si256( reinterpret_cast<__m256i const*>( a + i ) );
+    __m256i const y = _mm256_load_si256( reinterpret_cast<__m256i const*>( b + i ) );
+    _mm256_store_si256( reinterpret_cast<__m256i*>( r + i ), _mm256_xor_si256( x, y ) );
+  }
+#endif
+  for ( ; i < n; ++i )
+  {
+    r[i] = a[i] ^ b[i];
+  }
+}
+
+/* r[i] = ~a[i] */
+inline void bitwise_not( uint64_t* r, uint64_t const* a, uint64_t n )
+{
+  uint64_t i = 0u;
+#if defined( __AVX512F__ )
+  __m512i const ones = _mm512_set1_epi64( -1 );
+  for ( ; i + 8u <= n; i += 8u )
+  {
+    _mm512_store_si512( r + i, _mm512_xor_si512( _mm512_load_si512( a + i ), ones ) );
+  }
+#elif defined( __AVX2__ )
+  __m256i const ones = _mm256_set1_epi64x( -1 );
+  for ( ; i + 4u <= n; i += 4u )
+  {
+    __m256i const x = _mm256_load_si256( reinterpret_cast<__m256i const*>( a + i ) );
+    _mm256_store_si256( reinterpret_cast<__m256i*>( r + i ), _mm256_xor_si256( x, ones ) );
+  }
+#endif
+  for ( ; i < n; ++i )
+  {
+    r[i] = ~a[i];
+  }
+}
+
+/* r[i] = ( s[i] & ( t[i] ^ t_flip ) ) | ( ~s[i] & ( e[i] ^ e_flip ) ), the operands not necessarily aligned */
+inline void mux( uint64_t* r, uint64_t const* s, uint64_t const* t, uint64_t t_flip, uint64_t const* e, uint64_t e_flip, uint64_t n )
+{
+  uint64_t i = 0u;
+#if defined( __AVX512F__ )
+  __m512i const tf = _mm512_set1_epi64( static_cast<long long>( t_flip ) );
+  __m512i const ef = _mm512_set1_epi64( static_cast<long long>( e_flip ) );
+  for ( ; i + 8u <= n; i += 8u )
+  {
+    __m512i const x = _mm512_loadu_si512( s + i );
+    __m512i const y = _mm512_xor_si512( _mm512_loadu_si512( t + i ), tf );
+    __m512i const z = _mm512_xor_si512( _mm512_loadu_si512( e + i ), ef );
+    _mm512_storeu_si512( r + i, _mm512_or_si512( _mm512_and_si512( x, y ), _mm512_andnot_si512( x, z ) ) );
+  }
+#elif defined( __AVX2__ )
+  __m256i const tf = _mm256_set1_epi64x( static_cast<long long>( t_flip ) );
+  __m256i const ef = _mm256_set1_epi64x( static_cast<long long>( e_flip ) );
+  for ( ; i + 4u <= n; i += 4u )
+  {
+    __m256i const x = _mm256_loadu_si256( reinterpret_cast<__m256i const*>( s + i ) );
+    __m256i const y = _mm256_xor_si256( _mm256_loadu_si256( reinterpret_cast<__m256i const*>( t + i ) ), tf );
+    __m256i const z = _mm256_xor_si256( _mm256_loadu_si256( reinterpret_cast<__m256i const*>( e + i ) ), ef );
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( r + i ), _mm256_or_si256( _mm256_and_si256( x, y ), _mm256_andnot_si256( x, z ) ) );
+  }
+#endif
+  for ( ; i < n; ++i )
+  {
+    r[i] = ( s[i] & ( t[i] ^ t_flip ) ) | ( ~s[i] & ( e[i] ^ e_flip ) );
+  }
+}
+
+/* r[i] = ( a[i] & mask ) | ( a[i] & mask ) >> shift (if `down`), or << shift (otherwise).
+ * This is a cofactor with respect to a variable inside the words. */
+inline void shift_cofactor( uint64_t* r, uint64_t const* a, uint64_t n, uint64_t mask, uint32_t shift, bool down )
 {
-  switch( n )
+  uint64_t i = 0u;
+#if defined( __AVX512F__ )
+  __m512i const m = _mm512_set1_epi64( static_cast<long long>( mask ) );
+  for ( ; i + 8u <= n; i += 8u )
   {
-    case 2u: return 1u;
-    case 4u: return 2u;
-    case 8u: return 3u;
-    case 16u: return 4u;
-    case 32u: return 5u;
-    case 64u: return 6u;
-    default: return 0u;
+    __m512i const x = _mm512_and_si512( _mm512_load_si512( a + i ), m );
+    __m512i const y = down ? _mm512_srli_epi64( x, shift ) : _mm512_slli_epi64( x, shift );
+    _mm512_store_si512( r + i, _mm512_or_si512( x, y ) );
   }
+#elif defined( __AVX2__ )
+  __m256i const m = _mm256_set1_epi64x( static_cast<long long>( mask ) );
+  __m128i const s = _mm_cvtsi32_si128( static_cast<int>( shift ) );
+  for ( ; i + 4u <= n; i += 4u )
+  {
+    __m256i const x = _mm256_and_si256( _mm256_load_si256( reinterpret_cast<__m256i const*>( a + i ) ), m );
+    __m256i const y = down ? _mm256_srl_epi64( x, s ) : _mm256_sll_epi64( x, s );
+    _mm256_store_si256( reinterpret_cast<__m256i*>( r + i ), _mm256_or_si256( x, y ) );
+  }
+#endif
+  for ( ; i < n; ++i )
+  {
+    uint64_t const x = a[i] & mask;
+    r[i] = x | ( down ? x >> shift : x << shift );
+  }
+}
+
+/* Gather the 32 bits of word `w` where variable `var` (< 6) equals `polarity` into the lower half, in order. */
+inline uint64_t compress_var( uint64_t w, uint8_t var, bool polarity )
+{
+#if defined( __BMI2__ )
+  return _pext_u64( w, polarity ? var_mask_pos[var] : var_mask_neg[var] );
+#else
+  /* Blocks of 2^var selected bits are spaced every 2^(var+1) bits: merge neighboring blocks until there is one. */
+  uint64_t x = ( polarity ? w >> ( 1u << var ) : w ) & var_mask_neg[var];
+  for ( uint8_t k = var; k < 5u; ++k )
+  {
+    x = ( x & var_mask_neg[k] & var_mask_neg[k + 1u] ) | ( ( x >> ( 1u << k ) ) & var_mask_pos[k] & var_mask_neg[k + 1u] );
+  }
+  return x;
+#endif
+}
+
+/* Repeat each of the lowest 64 >> `d` bits of `w` 2^`d` times (1 <= `d` < 6), in order.
+ * This is a table over k variables seen as a table over k + `d` variables not depending on the `d` lowest ones. */
+inline uint64_t expand_bits( uint64_t w, uint32_t d )
+{
+#if defined( __BMI2__ )
+  static constexpr uint64_t spread_masks[] = { 0x0u, 0x5555555555555555u, 0x1111111111111111u, 0x0101010101010101u,
+                                               0x0001000100010001u, 0x0000000100000001u };
+  uint64_t x = _pdep_u64( w, spread_masks[d] );
+#else
+  /* Interleave zeros `d` times: each round moves bit i to bit 2i. */
+  uint64_t x = w & ( ( uint64_t( 1 ) << ( 64u >> d ) ) - 1u );
+  for ( uint32_t k = 0u; k < d; ++k )
+  {
+    x = ( x | ( x << 16u ) ) & 0x0000ffff0000ffffu;
+    x = ( x | ( x << 8u ) ) & 0x00ff00ff00ff00ffu;
+    x = ( x | ( x << 4u ) ) & 0x0f0f0f0f0f0f0f0fu;
+    x = ( x | ( x << 2u ) ) & 0x3333333333333333u;
+    x = ( x | ( x << 1u ) ) & 0x5555555555555555u;
+  }
+#endif
+  for ( uint32_t k = 0u; k < d; ++k )
+  {
+    x |= x << ( 1u << k );
+  }
+  return x;
 }
 
+/* whether a[i] == b[i] for all i */
+inline bool equal( uint64_t const* a, uint64_t const* b, uint64_t n )
+{
+  return std::memcmp( a, b, n * sizeof( uint64_t ) ) == 0;
+}
+
+} // namespace tt_kernels
+
 class Truth_Table
 {
 public:
+  using word_vector = std::vector<uint64_t, Aligned_Allocator<uint64_t>>;
+
   Truth_Table( uint8_t num_var )
-   : num_var( num_var ), bits( 0u )
+   : num_var( num_var ), bits( num_words( num_var ), 0u )
   {
-    assert( num_var <= 6u );
+    assert( num_var < 64u );
   }
 
+  /* The lowest (up to) 64 bits are given by `bits`, the other ones are 0. */
   Truth_Table( uint8_t num_var, uint64_t bits )
-   : num_var( num_var ), bits( bits & length_mask[num_var] )
+   : num_var( num_var ), bits( num_words( num_var ), 0u )
   {
-    assert( num_var <= 6u );
+    assert( num_var < 64u );
+    this->bits[0] = bits & length_mask[num_var < 6u ? num_var : 6u];
   }
 
   Truth_Table( const std::string str )
-   : num_var( power_two( str.size() ) ), bits( 0u )
+   : num_var( power_two( str.size() ) ), bits( num_words( num_var ), 0u )
   {
     if ( num_var == 0u )
     {
@@ -83,17 +357,16 @@ public:
     }
   }
 
-  bool get_bit( uint8_t const position ) const
+  bool get_bit( uint64_t const position ) const
   {
-    assert( position < ( 1 << num_var ) );
-    return ( ( bits >> position ) & 0x1 );
+    assert( position < ( uint64_t( 1 ) << num_var ) );
+    return ( ( bits[position >> 6] >> ( position & 63u ) ) & 0x1 );
   }
 
-  void set_bit( uint8_t const position )
+  void set_bit( uint64_t const position )
   {
-    assert( position < ( 1 << num_var ) );
-    bits |= ( uint64_t( 1 ) << position );
-    bits &= length_mask[num_var];
+    assert( position < ( uint64_t( 1 ) << num_var ) );
+    bits[position >> 6] |= ( uint64_t( 1 ) << ( position & 63u ) );
   }
 
   uint8_t n_var() const
@@ -101,21 +374,50 @@ public:
     return num_var;
   }
 
+  /* number of 64-bit words of the truth table */
+  uint64_t n_words() const
+  {
+    return bits.size();
+  }
+
   Truth_Table positive_cofactor( uint8_t const var ) const;
   Truth_Table negative_cofactor( uint8_t const var ) const;
   Truth_Table derivative( uint8_t const var ) const;
   Truth_Table consensus( uint8_t const var ) const;
   Truth_Table smoothing( uint8_t const var ) const;
+  Truth_Table shrink_cofactor( uint8_t const var, bool const polarity ) const;
+
+  /* whether the function is constant 0 */
+  bool is_zero() const
+  {
+    for ( auto const word : bits )
+    {
+      if ( word != 0u )
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /* Clear the bits beyond 2^num_var in a single-word table. */
+  void mask_bits()
+  {
+    if ( num_var < 6u )
+    {
+      bits[0] &= length_mask[num_var];
+    }
+  }
 
 public:
-  uint8_t const num_var; /* number of variables involved in the function */
-  uint64_t bits; /* the truth table */
+  uint8_t num_var; /* number of variables involved in the function */
+  word_vector bits; /* the truth table, 64 bits per word, bit 0 of word 0 first */
 };
 
 /* overload std::ostream operator for convenient printing */
 inline std::ostream& operator<<( std::ostream& os, Truth_Table const& tt )
 {
-  for ( int8_t i = ( 1 << tt.num_var ) - 1; i >= 0; --i )
+  for ( int64_t i = ( int64_t( 1 ) << tt.num_var ) - 1; i >= 0; --i )
   {
     os << ( tt.get_bit( i ) ? '1' : '0' );
   }
@@ -125,28 +427,37 @@ inline std::ostream& operator<<( std::ostream& os, Truth_Table const& tt )
 /* bit-wise NOT operation */
 inline Truth_Table operator~( Truth_Table const& tt )
 {
-  return Truth_Table( tt.num_var, ~tt.bits );
+  Truth_Table result( tt.num_var );
+  tt_kernels::bitwise_not( result.bits.data(), tt.bits.data(), tt.n_words() );
+  result.mask_bits();
+  return result;
 }
 
 /* bit-wise OR operation */
 inline Truth_Table operator|( Truth_Table const& tt1, Truth_Table const& tt2 )
 {
   assert( tt1.num_var == tt2.num_var );
-  return Truth_Table( tt1.num_var, tt1.bits | tt2.bits );
+  Truth_Table result( tt1.num_var );
+  tt_kernels::bitwise_or( result.bits.data(), tt1.bits.data(), tt2.bits.data(), tt1.n_words() );
+  return result;
 }
 
 /* bit-wise AND operation */
 inline Truth_Table operator&( Truth_Table const& tt1, Truth_Table const& tt2 )
 {
   assert( tt1.num_var == tt2.num_var );
-  return Truth_Table( tt1.num_var, tt1.bits & tt2.bits );
+  Truth_Table result( tt1.num_var );
+  tt_kernels::bitwise_and( result.bits.data(), tt1.bits.data(), tt2.bits.data(), tt1.n_words() );
+  return result;
 }
 
 /* bit-wise XOR operation */
 inline Truth_Table operator^( Truth_Table const& tt1, Truth_Table const& tt2 )
 {
   assert( tt1.num_var == tt2.num_var );
-  return Truth_Table( tt1.num_var, tt1.bits ^ tt2.bits );
+  Truth_Table result( tt1.num_var );
+  tt_kernels::bitwise_xor( result.bits.data(), tt1.bits.data(), tt2.bits.data(), tt1.n_words() );
+  return result;
 }
 
 /* check if two truth_tables are the same */
@@ -156,7 +467,7 @@ inline bool operator==( Truth_Table const& tt1, Truth_Table const& tt2 )
   {
     return false;
   }
-  return tt1.bits == tt2.bits;
+  return tt_kernels::equal( tt1.bits.data(), tt2.bits.data(), tt1.n_words() );
 }
 
 inline bool operator!=( Truth_Table const& tt1, Truth_Table const& tt2 )
@@ -167,13 +478,45 @@ inline bool operator!=( Truth_Table const& tt1, Truth_Table const& tt2 )
 inline Truth_Table Truth_Table::positive_cofactor( uint8_t const var ) const
 {
   assert( var < num_var );
-  return Truth_Table( num_var, ( bits & var_mask_pos[var] ) | ( ( bits & var_mask_pos[var] ) >> ( 1 << var ) ) );
+  Truth_Table result( num_var );
+  if ( var < 6u )
+  {
+    tt_kernels::shift_cofactor( result.bits.data(), bits.data(), n_words(), var_mask_pos[var], 1u << var, true );
+    result.mask_bits();
+  }
+  else
+  {
+    /* Copy the upper half of every block of 2 * 2^(var - 6) words onto its lower half. */
+    uint64_t const stride = uint64_t( 1 ) << ( var - 6u );
+    for ( uint64_t i = 0u; i < n_words(); i += 2u * stride )
+    {
+      std::memcpy( &result.bits[i], &bits[i + stride], stride * sizeof( uint64_t ) );
+      std::memcpy( &result.bits[i + stride], &bits[i + stride], stride * sizeof( uint64_t ) );
+    }
+  }
+  return result;
 }
 
 inline Truth_Table Truth_Table::negative_cofactor( uint8_t const var ) const
 {
   assert( var < num_var );
-  return Truth_Table( num_var, ( bits & var_mask_neg[var] ) | ( ( bits & var_mask_neg[var] ) << ( 1 << var ) ) );
+  Truth_Table result( num_var );
+  if ( var < 6u )
+  {
+    tt_kernels::shift_cofactor( result.bits.data(), bits.data(), n_words(), var_mask_neg[var], 1u << var, false );
+    result.mask_bits();
+  }
+  else
+  {
+    /* Copy the lower half of every block of 2 * 2^(var - 6) words onto its upper half. */
+    uint64_t const stride = uint64_t( 1 ) << ( var - 6u );
+    for ( uint64_t i = 0u; i < n_words(); i += 2u * stride )
+    {
+      std::memcpy( &result.bits[i], &bits[i], stride * sizeof( uint64_t ) );
+      std::memcpy( &result.bits[i + stride], &bits[i], stride * sizeof( uint64_t ) );
+    }
+  }
+  return result;
 }
 
 inline Truth_Table Truth_Table::derivative( uint8_t const var ) const
@@ -194,9 +537,69 @@ inline Truth_Table Truth_Table::smoothing( uint8_t const var ) const
   return positive_cofactor( var ) | negative_cofactor( var );
 }
 
+/* Returns the cofactor with respect to x_var = polarity as a function of the other num_var - 1 variables,
+ * where x_(var+1), ... are renumbered to x_var, .... */
+inline Truth_Table Truth_Table::shrink_cofactor( uint8_t const var, bool const polarity ) const
+{
+  assert( var < num_var );
+  Truth_Table result( num_var - 1u );
+  if ( var >= 6u )
+  {
+    /* Keep one half of every block of 2 * 2^(var - 6) words. */
+    uint64_t const stride = uint64_t( 1 ) << ( var - 6u );
+    for ( uint64_t i = 0u, j = 0u; i < n_words(); i += 2u * stride, j += stride )
+    {
+      std::memcpy( &result.bits[j], &bits[i + ( polarity ? stride : 0u )], stride * sizeof( uint64_t ) );
+    }
+  }
+  else
+  {
+    /* Every word gives 32 bits of the result. */
+    for ( uint64_t i = 0u; i < n_words(); ++i )
+    {
+      result.bits[i >> 1] |= tt_kernels::compress_var( bits[i], var, polarity ) << ( ( i & 1u ) * 32u );
+    }
+    result.mask_bits();
+  }
+  return result;
+}
+
+/* Hash functor to use truth tables as keys of unordered containers. */
+struct Truth_Table_Hash
+{
+  std::size_t operator()( Truth_Table const& tt ) const
+  {
+    uint64_t h = tt.num_var;
+    for ( auto const word : tt.bits )
+    {
+      h = ( h ^ word ) * 0x9e3779b97f4a7c15ull;
+      h ^= h >> 29;
+    }
+    return h;
+  }
+};
+
 /* Returns the truth table of f(x_0, ..., x_num_var) = x_var (or its complement). */
 inline Truth_Table create_tt_nth_var( uint8_t const num_var, uint8_t const var, bool const polarity = true )
 {
-  assert ( num_var <= 6u && var < num_var );
-  return Truth_Table( num_var, polarity ? var_mask_pos[var] : var_mask_neg[var] );
-}
\ No newline at end of file
+  assert( var < num_var );
+  Truth_Table tt( num_var );
+  if ( var < 6u )
+  {
+    uint64_t const mask = polarity ? var_mask_pos[var] : var_mask_neg[var];
+    for ( auto& word : tt.bits )
+    {
+      word = mask;
+    }
+    tt.mask_bits();
+  }
+  else
+  {
+    /* Whole words: word i is all ones iff bit (var - 6) of i equals the polarity. */
+    for ( uint64_t i = 0u; i < tt.n_words(); ++i )
+    {
+      tt.bits[i] = ( ( ( i >> ( var - 6u ) ) & 1u ) == ( polarity ? 1u : 0u ) ) ? ~uint64_t( 0 ) : 0u;
+    }
+  }
+  return tt;
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+/* Fields of a task shared between its owner and its thief. Tasks run by a `Work_Stealing_Pool`
+ * derive from it and provide `void run( uint32_t worker )`. */
+struct Stealable_Task
+{
+  static constexpr uint32_t no_thief = 0xffffffffu;
+
+  std::atomic<uint32_t> thief{ no_thief }; /* worker that stole the task */
+  std::atomic<bool> done{ false }; /* set by the thief when the task is finished */
+};
+
+/* A Chase-Lev deque of task pointers with a fixed capacity.
+ * The owner pushes and pops at the bottom; the other workers steal from the top. */
+template<class Task>
+class Task_Deque
+{
+public:
+  explicit Task_Deque( uint32_t capacity_log2 = 12u )
+    : top( 0 ), bottom( 0 ), buffer( new std::atomic<Task*>[1ull << capacity_log2] ), mask( ( 1ull << capacity_log2 ) - 1u )
+  {
+  }
+
+  /* Push `task` at the bottom (owner only). Return false if the deque is full. */
+  bool push( Task* task )
+  {
+    int64_t const b = bottom.load( std::memory_order_relaxed );
+    int64_t const t = top.load( std::memory_order_acquire );
+    if ( uint64_t( b - t ) > mask )
+    {
+      return false;
+    }
+    buffer[b & mask].store( task, std::memory_order_relaxed );
+    bottom.store( b + 1, std::memory_order_release );
+    return true;
+  }
+
+  /* Pop the task at the bottom (owner only), or nullptr if it has been stolen. */
+  Task* pop()
+  {
+    int64_t const b = bottom.load( std::memory_order_relaxed ) - 1;
+    bottom.store( b, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    int64_t t = top.load( std::memory_order_relaxed );
+    Task* task = nullptr;
+    if ( t <= b )
+    {
+      task = buffer[b & mask].load( std::memory_order_relaxed );
+      if ( t == b )
+      {
+        /* Last task: race against the thieves for it. */
+        if ( !top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+        {
+          task = nullptr;
+        }
+        bottom.store( b + 1, std::memory_order_relaxed );
+      }
+    }
+    else
+    {
+      bottom.store( b + 1, std::memory_order_relaxed );
+    }
+    return task;
+  }
+
+  /* Steal the task at the top, or nullptr if the deque is empty or another worker won the race. */
+  Task* steal()
+  {
+    int64_t t = top.load( std::memory_order_acquire );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    int64_t const b = bottom.load( std::memory_order_acquire );
+    if ( t >= b )
+    {
+      return nullptr;
+    }
+    Task* const task = buffer[t & mask].load( std::memory_order_relaxed );
+    if ( !top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+    {
+      return nullptr;
+    }
+    return task;
+  }
+
+private:
+  static constexpr std::size_t cache_line = 64u;
+
+  /* `top` and `bottom` are kept on cache lines of their own (64 bytes) by padding rather than `alignas`, as the
+   * deques are allocated with `new`, which ignores over-alignment before C++17. */
+  char pad_front[cache_line];
+  std::atomic<int64_t> top;
+  char pad_middle[cache_line - sizeof( std::atomic<int64_t> )];
+  std::atomic<int64_t> bottom;
+  char pad_back[cache_line - sizeof( std::atomic<int64_t> )];
+  std::unique_ptr<std::atomic<Task*>[]> buffer;
+  uint64_t mask;
+};
+
+/* A fork-join pool in the style of Lace: a task spawned by a worker can be stolen by the idle workers,
+ * and a worker waiting for a stolen task steals back from the thief in the meantime (leapfrogging),
+ * which bounds the stack depth. Worker 0 is the thread calling `run`. */
+template<class Task>
+class Work_Stealing_Pool
+{
+public:
+  explicit Work_Stealing_Pool( uint32_t num_workers )
+    : deques( num_workers ), running( false ), stopping( false ), epoch( 0u )
+  {
+    assert( num_workers > 0u );
+    for ( auto& deque : deques )
+    {
+      deque.reset( new Task_Deque<Task>() );
+    }
+    for ( uint32_t w = 1u; w < num_workers; ++w )
+    {
+      threads.emplace_back( [this, w]() { work( w ); } );
+    }
+  }
+
+  ~Work_Stealing_Pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock( mutex );
+      stopping = true;
+    }
+    wake_up.notify_all();
+    for ( auto& thread : threads )
+    {
+      thread.join();
+    }
+  }
+
+  Work_Stealing_Pool( Work_Stealing_Pool const& ) = delete;
+  Work_Stealing_Pool& operator=( Work_Stealing_Pool const& ) = delete;
+
+  uint32_t num_workers() const
+  {
+    return deques.size();
+  }
+
+  /* Run `task` on the calling thread as worker 0, with the other workers stealing the tasks it spawns. */
+  void run( Task& task )
+  {
+    {
+      std::lock_guard<std::mutex> lock( mutex );
+      running.store( true, std::memory_order_release );
+      ++epoch;
+    }
+    wake_up.notify_all();
+    task.run( 0u );
+    running.store( false, std::memory_order_release );
+  }
+
+  /* Make `task` available to the other workers. Return false if the deque of `worker` is full,
+   * in which case the task must be run directly instead of synced. */
+  bool spawn( uint32_t worker, Task& task )
+  {
+    return deques[worker]->push( &task );
+  }
+
+  /* Wait for `task`, the last task spawned by `worker`, running it directly if it has not been stolen. */
+  void sync( uint32_t worker, Task& task )
+  {
+    Task* const popped = deques[worker]->pop();
+    if ( popped != nullptr )
+    {
+      assert( popped == &task && "Tasks must be synced in the reverse order of spawning." );
+      task.run( worker );
+      return;
+    }
+
+    uint32_t thief;
+    while ( ( thief = task.thief.load( std::memory_order_acquire ) ) == Stealable_Task::no_thief )
+    {
+      std::this_thread::yield();
+    }
+    while ( !task.done.load( std::memory_order_acquire ) )
+    {
+      if ( !steal_and_run( worker, thief ) )
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+private:
+  /* Loop of the workers other than 0: steal from random victims while a task is running. */
+  void work( uint32_t worker )
+  {
+    uint64_t seen_epoch = 0u;
+    uint64_t random = 0x9e3779b97f4a7c15ull * ( worker + 1u );
+    while ( true )
+    {
+      {
+        std::unique_lock<std::mutex> lock( mutex );
+        wake_up.wait( lock, [&]() { return stopping || epoch != seen_epoch; } );
+        if ( stopping )
+        {
+          return;
+        }
+        seen_epoch = epoch;
+      }
+      while ( running.load( std::memory_order_acquire ) )
+      {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        uint32_t const victim = random % deques.size();
+        if ( victim == worker || !steal_and_run( worker, victim ) )
+        {
+          std::this_thread::yield();
+        }
+      }
+    }
+  }
+
+  bool steal_and_run( uint32_t worker, uint32_t victim )
+  {
+    Task* const task = deques[victim]->steal();
+    if ( task == nullptr )
+    {
+      return false;
+    }
+    task->thief.store( worker, std::memory_order_release );
+    task->run( worker );
+    task->done.store( true, std::memory_order_release );
+    return true;
+  }
+
+private:
+  std::vector<std::unique_ptr<Task_Deque<Task>>> deques;
+  std::vector<std::thread> threads;
+  std::atomic<bool> running; /* whether `run` is in progress */
+
+  /* sleeping between two runs */
+  std::mutex mutex;
+  std::condition_variable wake_up;
+  bool stopping;
+  uint64_t epoch; /* number of runs started */
+};